@@ -5,95 +5,157 @@
 // Written by Luben Hristov
 //
 // 12-08-24 -- Creating the file with ANSI command definitions
+// 17-10-26 -- constexpr strings, so the command table can check its order at compile time
 //
 //================================================================
 #ifndef _ANSI_COMMANDS_H
 #define _ANSI_COMMANDS_H
 
-const char MEAS_Z0[]              = "z";                // command for measuring inpedance
-const char TEMPERAT0[]            = "temperature";      // command for reading the temperature
-const char    TEMP_CELSIUS[]      = "cls";              // temperature in celsius
+constexpr char MEAS_Z0[]              = "z";                // command for measuring inpedance
+constexpr char TEMPERAT0[]            = "temperature";      // command for reading the temperature
+constexpr char    TEMP_CELSIUS[]      = "cls";              // temperature in celsius
 #define TEMP_CELSIUS_VAL    1                           // the Celsius enum value
-const char    TEMP_FARENHEIT[]    = "fht";              // temperature in Farenheit
+constexpr char    TEMP_FARENHEIT[]    = "fht";              // temperature in Farenheit
 #define TEMP_FARENHEIT_VAL  0                           // the Farenheit enum value
 
-const char ABORT0[]              = "abort";             // command for aborting the measurements
+constexpr char ABORT0[]              = "abort";             // command for aborting the measurements
 
-const char FREQUENCY0[]           = "frequency";        // command for setting the frequency in kHz
-const char FREQUENCY_POS_STR[]    = "kHz";              // post string of frequency command
+constexpr char FREQUENCY0[]           = "frequency";        // command for setting the frequency in kHz
+constexpr char FREQUENCY_POS_STR[]    = "kHz";              // post string of frequency command
 
-const char MAGNITUDE0[]           = "magnitude";        // command for setting the magnitude in V
-const char MAGNITUDE_POS_STR[]    = "V";                // post string of magnitude command
+constexpr char MAGNITUDE0[]           = "magnitude";        // command for setting the magnitude in V
+constexpr char MAGNITUDE_POS_STR[]    = "V";                // post string of magnitude command
 
-const char OFFSET0[]              = "offset";           // command for setting the offset in V
-const char OFFSET_POS_STR[]       = "V";                // post string of offset command
+constexpr char OFFSET0[]              = "offset";           // command for setting the offset in V
+constexpr char OFFSET_POS_STR[]       = "V";                // post string of offset command
 
-const char SETGAIN0[]             = "setgain";          // command for setting vgain or igain
-const char    SETGAIN_AUTO1[]     = "auto";             // sub1 for auto mode
-const char    SETGAIN_VGAIN1[]    = "ch0";              // sub1 for setting vgain (ch0)
-const char    SETGAIN_IGAIN1[]    = "ch1";              // sub1 for setting vgain (ch0)
-const char    SETGAIN_RESP_V1[]   = "volt gain = ";     // set voltage gain
-const char    SETGAIN_RESP_I1[]   = "curr gain = ";     // set current gain
+constexpr char SETGAIN0[]             = "setgain";          // command for setting vgain or igain
+constexpr char    SETGAIN_AUTO1[]     = "auto";             // sub1 for auto mode
+constexpr char    SETGAIN_VGAIN1[]    = "ch0";              // sub1 for setting vgain (ch0)
+constexpr char    SETGAIN_IGAIN1[]    = "ch1";              // sub1 for setting vgain (ch0)
+constexpr char    SETGAIN_RESP_V1[]   = "volt gain = ";     // set voltage gain
+constexpr char    SETGAIN_RESP_I1[]   = "curr gain = ";     // set current gain
 
-const char TRIG_MODE0[]           = "trig_mode";         // set trigger mode
-const char    TRIG_MODE_INT[]     = "internal";         // internal trigger mode
+constexpr char TRIG_MODE0[]           = "trig_mode";         // set trigger mode
+constexpr char    TRIG_MODE_INT[]     = "internal";         // internal trigger mode
 #define TRIG_MODE_INTER_VAL    0                        // the internal trigger mode value
-const char    TRIG_MODE_EXT[]     = "external";         // external trigger modet
+constexpr char    TRIG_MODE_EXT[]     = "external";         // external trigger modet
 #define TRIG_MODE_EXTERN_VAL   1                        // the external trigger mode value
 
-const char AVERAGE0[]             = "average";          // command for setting the averaging per sample
-const char DISPLAY0[]             = "display";          // command for setting the display mode
+constexpr char AVERAGE0[]             = "average";          // command for setting the averaging per sample
+constexpr char DISPLAY0[]             = "display";          // command for setting the display mode
 
-const char MDELAY0[]               = "mdelay";          // command for setting the setting the measuring delay
-const char MDELAY_POS_STR[]        = "msec";            // post string of mdelay command
+constexpr char MDELAY0[]               = "mdelay";          // command for setting the setting the measuring delay
+constexpr char MDELAY_POS_STR[]        = "msec";            // post string of mdelay command
 
-const char TDELAY0[]               = "tdelay";          // command for setting the setting the trigger delay
-const char TDELAY_POS_STR[]        = "msec";            // post string of tdelay command
+constexpr char TDELAY0[]               = "tdelay";          // command for setting the setting the trigger delay
+constexpr char TDELAY_POS_STR[]        = "msec";            // post string of tdelay command
 
-const char COUNT0[]                = "count";           // command for setting the number of counts per measurement
-const char TCOUNT0[]               = "tcount";          // command for setting the number of trigger counts
+constexpr char COUNT0[]                = "count";           // command for setting the number of counts per measurement
+constexpr char CYCLES0[]               = "cycles";          // command for setting the number of cycles per measurement
+constexpr char INTEGRATION0[]          = "integration";     // command for setting the integration time
+constexpr char TCOUNT0[]               = "tcount";          // command for setting the number of trigger counts
 
-const char SWEEPTYPE0[]            = "sweep_type";      // command for setting the sweep type
-const char    SWEEPTYPE_FREQ1[]    = "frequency";       // sub1 for type as frequency
-const char    SWEEPTYPE_MAGN1[]    = "magnitude";       // sub1 for type as magnitude
-const char    SWEEPTYPE_OFFSET1[]  = "offset";          // sub1 for type as offset
-const char    SWEEPTYPE_OFF1[]     = "off";             // sub1 for sweep off
+constexpr char SWEEPTYPE0[]            = "sweep_type";      // command for setting the sweep type
+constexpr char    SWEEPTYPE_FREQ1[]    = "frequency";       // sub1 for type as frequency
+constexpr char    SWEEPTYPE_MAGN1[]    = "magnitude";       // sub1 for type as magnitude
+constexpr char    SWEEPTYPE_OFFSET1[]  = "offset";          // sub1 for type as offset
+constexpr char    SWEEPTYPE_OFF1[]     = "off";             // sub1 for sweep off
 
-const char SWEEP_SCALE0[]          = "sweep_scale";     // type fo the sweep scale
-const char    SWEEP_SCALE_LIN1[]   = "linear";          // internal trigger mode
+constexpr char SWEEP0[]                = "sweep";           // <sweep start stop points [linear|log]> in kHz - module sweep, records <counter,freq,Rm,Xm>
+constexpr char    SWEEP_LIST1[]        = "list";            // <sweep list f1 f2 ...> in kHz - the bridge steps the frequencies
+constexpr char SWEEP_SCALE0[]          = "sweep_scale";     // type fo the sweep scale
+constexpr char    SWEEP_SCALE_LIN1[]   = "linear";          // internal trigger mode
 #define SWEEP_SCALE_LIN_VAL    0                        // the internal trigger mode value
-const char    SWEEP_SCALE_LOG1[]   = "log";             // external trigger modet
+constexpr char    SWEEP_SCALE_LOG1[]   = "log";             // external trigger modet
 #define SWEEP_SCALE_LOG_VAL    1                        // the external trigger mode value
 
-const char CALIBRATE0[]            = "calibrate";      // command for calibration
-const char    CALIBRATE_OPEN1[]    = "open";           // sub1 start open calibration for particular freq/vgain/igain trinity
-const char    CALIBRATE_SHORT1[]   = "short";          // sub1 start short calibration for particular freq/vgain/igain trinity
-const char    CALIBRATE_RT_XT1[]   = "rt";             // sub1 start load calibration - sub2 is the value of RT
-const char      CALIBRATE_XT_XT3[] = "xt";             // sub3 start load calibration - sub4 is the value of XT
-
-const char    CALIBRATE_ON1[]      = "on";             // sub1 set calibration to on (apply calibration for all measurements)
-const char    CALIBRATE_OFF1[]     = "off";            // sub1 set calibration to off (calibration not applied to measured data)
-const char    CALIBRATE_RELOAD1[]  = "reload";         // sub1 to reload calibration
-const char    CALIBRATE_COMMIT1[]  = "commit";         // sub1 to comnit calibration (store in FLASH coeff for curent freq/vgain/igain trinity)
-const char    CALIBRATE_ERASE1[]   = "erase";          // sub1 to erase calibration from FLASH (will require to set password)
-const char    CALIBRATE_LIST1[]    = "list";           // sub1 to list the availible calibration (withot sub2 shows the frequencies, with sub2=freq for particular ferquency)
-
-const char READCAL0[]              = "rdcal";          // read from RAM the calibration coefficients for the assigned freq/vgain/igain trinity
-const char RESETCAL0[]             = "resetcal";       // resets in RAM calibration coefficients for the assigned freq/vgain/igain trinity
-const char STORECAL0[]             = "storecal";       // store specified calibration coefficient (Ro,Xo,Go,Bo...) in RAM for the assigned freq/vgain/igain trinity
-
-const char    STORE_CAL_FIELDS1[12][3] = {"Ro","Xo","Go","Bo",  "Rs","Xs","Gs","Bs",  "Rg","Xg","Gg","Bg"};  // array of tokens
-
-const char IDN0[]                  = "*idn?";          // read the module ID and firmware
-const char RESET0[]                = "reset";          // resets the module
-const char SELFTEST0[]             = "selftest";       // runs selftest
-const char GPIO_CTRL0[]            = "gpio_ctrl";      // GPIO pins control
-
-const char CMND_VOID[]             = "void";           // void command, for debugging purposes
+constexpr char CALIBRATE0[]            = "calibrate";      // command for calibration
+constexpr char    CALIBRATE_OPEN1[]    = "open";           // sub1 start open calibration for particular freq/vgain/igain trinity
+constexpr char    CALIBRATE_SHORT1[]   = "short";          // sub1 start short calibration for particular freq/vgain/igain trinity
+constexpr char    CALIBRATE_RT_XT1[]   = "rt";             // sub1 start load calibration - sub2 is the value of RT
+constexpr char      CALIBRATE_XT_XT3[] = "xt";             // sub3 start load calibration - sub4 is the value of XT
+
+constexpr char    CALIBRATE_ON1[]      = "on";             // sub1 set calibration to on (apply calibration for all measurements)
+constexpr char    CALIBRATE_OFF1[]     = "off";            // sub1 set calibration to off (calibration not applied to measured data)
+constexpr char    CALIBRATE_RELOAD1[]  = "reload";         // sub1 to reload calibration
+constexpr char    CALIBRATE_COMMIT1[]  = "commit";         // sub1 to comnit calibration (store in FLASH coeff for curent freq/vgain/igain trinity)
+constexpr char    CALIBRATE_ERASE1[]   = "erase";          // sub1 to erase calibration from FLASH (will require to set password)
+constexpr char    CALIBRATE_LIST1[]    = "list";           // sub1 to list the availible calibration (withot sub2 shows the frequencies, with sub2=freq for particular ferquency)
+
+constexpr char READCAL0[]              = "rdcal";          // read from RAM the calibration coefficients for the assigned freq/vgain/igain trinity
+constexpr char READCALALL0[]           = "rdcalall";       // all coefficients + status/freq/temp of one or all 16 vgain/igain sets in one block
+constexpr char    READCALALL_BIN1[]    = "bin";            // <rdcalall [vgain igain] bin> - binary records instead of text lines
+constexpr char RESETCAL0[]             = "resetcal";       // resets in RAM calibration coefficients for the assigned freq/vgain/igain trinity
+constexpr char STORECAL0[]             = "storecal";       // store specified calibration coefficient (Ro,Xo,Go,Bo...) in RAM for the assigned freq/vgain/igain trinity
+
+constexpr char    STORE_CAL_FIELDS1[12][3] = {"Ro","Xo","Go","Bo",  "Rs","Xs","Gs","Bs",  "Rg","Xg","Gg","Bg"};  // array of tokens
+
+constexpr char IDN0[]                  = "*idn?";          // read the module ID and firmware
+constexpr char RESET0[]                = "reset";          // resets the module
+constexpr char SELFTEST0[]             = "selftest";       // runs selftest
+constexpr char GPIO_CTRL0[]            = "gpio_ctrl";      // GPIO pins control
+
+constexpr char CMND_VOID[]             = "void";           // void command, for debugging purposes
+
+//------ Bridge settings (handled by the bridge, not sent to ADMX)
+constexpr char DRAIN0[]                = "drain";          // time budget in us for pulling all Z records from FIFO in one pass (0 - one record per 5ms)
+constexpr char DRAIN_POS_STR[]         = "us";             // post string of drain command
+constexpr char SPI_TIMING0[]           = "spi_timing";     // SPI frame timing profile
+constexpr char    SPI_TIMING_SAFE1[]   = "safe";           // original gaps: byte 4us, SS 4us, frame 40us
+constexpr char    SPI_TIMING_FAST1[]   = "fast";           // whole frame in one transfer, frame gap 20us from the previous frame end
+constexpr char SHADOW0[]               = "shadow";         // reads of parameters answered from the bridge copy
+constexpr char    SHADOW_ON1[]         = "on";             // use the copy (default)
+constexpr char    SHADOW_OFF1[]        = "off";            // always read the module
+constexpr char    SHADOW_CLEAR1[]      = "clear";          // forget all kept values
+constexpr char    SHADOW_FORCE1[]      = "?";              // <frequency ?> - this read goes to the module
+constexpr char STATS0[]                = "stats";          // runtime counters (frames, polls, queues, records, USB, loop time)
+constexpr char    STATS_RESET1[]       = "reset";          // clear the counters
+constexpr char STATUS0[]               = "status";         // bridge state, queued commands, FIFO depth (also answered during z/calibrate)
+constexpr char TRACE0[]                = "trace";          // SPI frames trace in RAM
+constexpr char    TRACE_ARM1[]         = "arm";            // clear and record, freeze on error/timeout
+constexpr char    TRACE_OFF1[]         = "off";            // stop and clear (default)
+constexpr char    TRACE_FREEZE1[]      = "freeze";         // stop recording now
+constexpr char    TRACE_DUMP1[]        = "dump";           // <index,time_us,cmd,addr,out,in> - the oldest first
+constexpr char RXFLOW0[]               = "rxflow";         // receive flow control, free space of the input queues
+constexpr char    RXFLOW_USB1[]        = "usb";            // stop reading near full - USB holds the host (default)
+constexpr char    RXFLOW_XON1[]        = "xon";            // XOFF at the high-water mark, XON when there is room
+constexpr char    RXFLOW_OFF1[]        = "off";            // no backpressure, dropped lines are reported
+constexpr char ZSTAMP0[]               = "zstamp";         // Z records end with <seq,time_us,pending> - pending is an estimate of the records left in the FIFO
+constexpr char    ZSTAMP_ON1[]         = "on";             // stamp every record
+constexpr char    ZSTAMP_OFF1[]        = "off";            // plain records (default)
+constexpr char LATENCY0[]              = "latency";        // learned DONE latency per command (min/avg/max)
+constexpr char    LATENCY_ON1[]        = "on";             // wait the learned time, then poll with backoff (default)
+constexpr char    LATENCY_OFF1[]       = "off";            // fixed polling every 25us
+constexpr char    LATENCY_RESET1[]     = "reset";          // forget the learned latencies
+constexpr char LEAN0[]                 = "lean";           // warning codes read only when reported (fewer SPI frames)
+constexpr char    LEAN_ON1[]           = "on";             // status only, warnings on demand (default)
+constexpr char    LEAN_OFF1[]          = "off";            // read warning codes after every command with WARN
+constexpr char ZFORMAT0[]              = "zformat";        // output format of Z records
+constexpr char    ZFORMAT_ASCII1[]     = "ascii";          // text records <counter,Rm,Xm> (default)
+constexpr char    ZFORMAT_BINARY1[]    = "binary";         // binary records <A5,type,len,counter,Rm,Xm,checksum>, byte stuffed (see CmndProcess.h)
+constexpr char ZDERIVED0[]             = "zderived";       // Z records carry <counter,freq,q1,q2...> computed on the bridge
+constexpr char    ZDERIVED_OFF1[]      = "off";            // raw Rm/Xm records (default)
+constexpr char    ZDERIVED_Z1[]        = "z";              // |Z| in ohm
+constexpr char    ZDERIVED_PHASE1[]    = "phase";          // phase in degrees
+constexpr char    ZDERIVED_RS1[]       = "rs";             // series resistance (Rm)
+constexpr char    ZDERIVED_XS1[]       = "xs";             // series reactance (Xm)
+constexpr char    ZDERIVED_CS1[]       = "cs";             // series capacitance in F
+constexpr char    ZDERIVED_CP1[]       = "cp";             // parallel capacitance in F
+constexpr char    ZDERIVED_LS1[]       = "ls";             // series inductance in H
+constexpr char    ZDERIVED_LP1[]       = "lp";             // parallel inductance in H
+constexpr char    ZDERIVED_RP1[]       = "rp";             // parallel resistance in ohm
+constexpr char    ZDERIVED_D1[]        = "d";              // dissipation factor R/|X|
+constexpr char    ZDERIVED_Q1[]        = "q";              // quality factor |X|/R
+constexpr char ZSTATS0[]               = "zstats";         // N, mean, std, min, max of Rm/Xm at the end of every run
+constexpr char    ZSTATS_ON1[]         = "on";             // summary only, the records are not sent
+constexpr char    ZSTATS_ALL1[]        = "all";            // records and summary
+constexpr char    ZSTATS_OFF1[]        = "off";            // records only (default)
 
 
 //------ Some specific strings for SPI bridge
 #define BRIDGE_RESET              (char(0xB0))          // this single char command (0xB0) will reset the bridge instantly to init state
-const char VOID_STR[]              = "";                // command for measuring inpedance
+#define BATCH_SEPARATOR           (';')                 // <frequency 10; magnitude 0.5; z> - commands executed back to back, one delimiter at the end
+constexpr char VOID_STR[]              = "";                // command for measuring inpedance
 
 #endif /* end _ANSI_COMMANDS_H */
\ No newline at end of file
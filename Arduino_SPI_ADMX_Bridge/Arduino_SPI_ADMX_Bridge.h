@@ -22,4 +22,24 @@
 #define SIZE_RECEIVER_QUEUE    4000      // we need deeper queue for inpQueue to store the sent from PC commands
 #define SIZE_RECORD_LEN_QUEUE  200      // we need shalower queue for storing the length of records
 
+//-------- Receive flow control - <rxflow usb|xon|off>
+// usb - we stop reading Serial near full queues, the USB stack holds the host (default). The headroom is kept
+//       for the rest of the current line, 0xB0 and (while z/calibrate runs) lines which can be abort/status/stats -
+//       a line is dropped (reported) only when even the headroom is used up
+// xon - we read everything, XOFF is sent at the high-water mark and XON when there is room again
+// off - no backpressure, a line which doesn't fit is dropped and reported
+enum rxFlow_t {RX_FLOW_OFF, RX_FLOW_USB, RX_FLOW_XON};
+#define RX_HEADROOM_CHARS      160      // usb/xon - keep room for one full command line (COMMAND_STR_LEN)
+#define RX_HEADROOM_LINES        2      // usb/xon - free records in recLenQueue
+#define RX_XON_CHARS          1000      // xon - XON when this many chars are free again
+#define RX_XON_LINES            20      // xon - and this many records
+#define XON_CHAR              0x11
+#define XOFF_CHAR             0x13
+
+extern rxFlow_t rxFlowMode;
+extern unsigned long rxOverflows;  // lines dropped because the queues (in usb mode the headroom as well) were full
+int RxFree_Chars(void);            // free space of inpQueue
+int RxFree_Lines(void);            // free records of recLenQueue
+void RxFlow_Leave(void);           // leaving xon mode - XON if the host was stopped
+
 #endif  // end _SPI_ADMX_BRIDGE_H
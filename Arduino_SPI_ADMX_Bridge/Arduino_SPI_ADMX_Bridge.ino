@@ -9,6 +9,9 @@
 // 07-08-24 -- Starting the project, testing the serial, setting DTR to receive data
 // 02-09-24 -- Adding <calibrate commit>
 // 30-09-24 -- Adding <gpio_ctrl> command 
+// 17-10-26 -- ';' separated commands on one line with a single delimiter
+// 17-10-26 -- receive flow control, dropped lines reported as errors
+// 17-10-26 -- priority lane - abort/status/stats while z/calibrate runs
 //================================================================
 
 #include <Strings.h>
@@ -23,6 +26,11 @@
 #include "SlowTask.h"                   // inlcude Slow task functionality
 #include "ANSI_cmnd.h"                 // access definition of BRIDGE_RESET
 #include "LIF.h"                        // include debugger interface (in this module we set the IO pins)
+#include "ShadowCache.h"                // shadow copy of the ADMX parameters
+#include "SerialOut.h"                  // TX ring buffer
+#include "CalSupport.h"                 // calibration index
+#include "Sweep.h"                      // sweep is stopped by the bridge reset
+#include "Stats.h"                      // runtime counters
 
 //-------- Global variables definitions used in the code
 int stat_TX_LED = 1;              // control the TX LED status to toggle on transmissions 
@@ -33,6 +41,11 @@ uint32_t statusAdmx;              // here we store the status of the last operat
 int curCommandLen = 0;            // static valiable for main asscociated with inpQueue, which keeps track how many records we 
 int pendingRec = 0;               // keeps track of pending records
 int inQueue = 0;                  // keeps track of the commands in the queue
+rxFlow_t rxFlowMode = RX_FLOW_USB;  // receive flow control
+bool rxLineDropped = false;       // chars of the current line didn't fit into inpQueue
+bool rxXoffSent = false;          // xon mode - the host was told to stop
+unsigned long rxOverflows = 0;    // lines dropped because the queues were full
+int rxDropPending = 0;            // dropped lines which couldn't get their 0 length record yet (recLenQueue full)
 
 CircularBuffer<char,    SIZE_RECEIVER_QUEUE>    inpQueue;     // define new queue - this is the input queue where all chars are accumulated
 CircularBuffer<int16_t, SIZE_RECORD_LEN_QUEUE> recLenQueue;   // define new queue - this is the CRLF records length queue (also tell us how many commands are wauting in the queue)
@@ -57,6 +70,7 @@ void setup() {
   pinMode(LIF_CLK,  OUTPUT);     // LIF clock is output
   digitalWrite(LIF_DATA, LOW);   
   digitalWrite(LIF_CLK, LOW);    
+  LIF_Begin();                   // LIF bytes go out from a timer IRQ
 
 
   digitalWrite(SPI_SS_PIN, HIGH);   // Keeep SS in high state
@@ -77,13 +91,112 @@ void setup() {
 
 
 
+//================================================================
+// Receive queues - free space and flow control
+//================================================================
+int RxFree_Chars(void) { return inpQueue.available(); }
+int RxFree_Lines(void) { return recLenQueue.available(); }
+
+bool RxQueue_NearFull(void)
+{
+  return (inpQueue.available() < RX_HEADROOM_CHARS) || (recLenQueue.available() < RX_HEADROOM_LINES);
+}
+
+void RxFlow_XonXoff(void)   // xon mode - tell the host to stop/continue
+{
+  if (!rxXoffSent && RxQueue_NearFull()) {
+    Out_Char(XOFF_CHAR);
+    Out_Flush();
+    rxXoffSent = true;
+  }
+  else if (rxXoffSent && (inpQueue.available() >= RX_XON_CHARS) && (recLenQueue.available() >= RX_XON_LINES)) {
+    Out_Char(XON_CHAR);
+    Out_Flush();
+    rxXoffSent = false;
+  }
+}
+
+void RxFlow_Leave(void)     // xon mode left - a host stopped by XOFF would wait for XON for good
+{
+  if (rxXoffSent) {
+    Out_Char(XON_CHAR);
+    Out_Flush();
+    rxXoffSent = false;
+  }
+}
+
+bool RxScan_Next(void)     // usb mode, near full - TRUE if the next char is read anyway (the headroom takes it)
+{
+  if ((curCommandLen > 0) || rxLineDropped) {
+    return true;                         // finish the current line - it fits into the headroom (or is dropped)
+  }
+  char nextChar = (char)Serial.peek();
+  if ((nextChar == BRIDGE_RESET) || (nextChar == '\r') || (nextChar == '\n')) {
+    return true;                         // reset, or an empty line - nothing is queued
+  }
+  return (stateMeasureZ != IDLE) && Priority_FirstChar(nextChar);   // can be abort/status/stats - a normal line with
+                                         // the same first char goes into the headroom, or is dropped when it is used up
+}
+
+void RxDrop_Records(void)   // 0 length records of the dropped lines, as soon as there is room in recLenQueue
+{
+  while ((rxDropPending > 0) && !recLenQueue.isFull()) {
+    recLenQueue.push(0);
+    rxDropPending--;
+  }
+}
+
+void RxLine_Drop(void)      // take back the queued chars of the current line, a 0 length record reports it when its turn comes
+{
+  while (curCommandLen > 0) {
+    inpQueue.pop();
+    curCommandLen--;
+  }
+  rxLineDropped = false;
+  rxOverflows++;
+  rxDropPending++;
+  RxDrop_Records();
+}
+
+//================================================================
+// Busy bridge - abort/status/stats are executed when received, not queued behind the running z/calibrate
+//================================================================
+#define PRIORITY_LINE_LEN  16             // longer lines can't be a priority command
+
+bool RxLine_Priority(void)
+{
+  if ((stateMeasureZ == IDLE) || (curCommandLen >= PRIORITY_LINE_LEN)) {
+    return false;
+  }
+  char line[PRIORITY_LINE_LEN];
+  int first = inpQueue.size() - curCommandLen;   // the line is at the end of inpQueue
+  for (int ii = 0; ii < curCommandLen; ii++) {
+    line[ii] = inpQueue[first + ii];
+  }
+  line[curCommandLen] = char(0);
+  if (!Priority_Command(line)) {
+    return false;
+  }
+  while (curCommandLen > 0) {              // done - it doesn't go into the queue
+    inpQueue.pop();
+    curCommandLen--;
+  }
+  return true;
+}
+
 //================================================================
 // MAIN loop is here - the functionality of the program
 //================================================================
 void loop() {
 
+  Stats_LoopTime();                      // loop period histogram
+
 //--------- Data receiving is here --------------
+  RxDrop_Records();                      // dropped lines get their error in the order they came
   while (Serial.available()) {           // if new data available - read all pending data
+    if ((rxFlowMode == RX_FLOW_USB) && RxQueue_NearFull() && !RxScan_Next()) {
+      break;                             // the rest stays in the USB buffer - the host waits till we read it
+    }
     
     char inChar = (char)Serial.read();   // get the new byte:
 
@@ -91,50 +204,98 @@ void loop() {
       recLenQueue.clear();  // clears this FIFO
       inpQueue.clear();     // clears input pending data 
       curCommandLen = 0;    // void all data 
+      rxLineDropped = false;
+      rxDropPending = 0;
       stateMeasureZ = IDLE; // set status to IDLE and all peding measurements will be lost
+      Shadow_InvalidateAll(); // the module may be reset/replaced - don't trust the kept parameters
+      CalIndex_Clear();       // nor the list of its calibrations
+      Sweep_Abort(false);     // module stopped, sweep settings written back
+      Batch_Abort();          // the rest of a ';' line is not executed
       //------ Here we can pull down the hardware reset for the ADMX module and initialise it (of cut the power supply for short time)
       Bridge_SerialPrintLn("Bridge Reset");   // here we print the special character 0x0C which works as LabView delimiter for the commands
       Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
     } 
     else if (inChar == '\n') {           // if the incoming character is a LF newline, set a flag so the main loop can
-      if (curCommandLen > 0) {           // check if we already stored some data
+      if (rxLineDropped) {
+        RxLine_Drop();                   // the line is not complete - don't execute it
+      }
+      else if (RxLine_Priority()) {      // executed right now, even with full queues
+      }
+      else if ((curCommandLen > 0) && (recLenQueue.isFull() || (rxDropPending > 0))) {
+        RxLine_Drop();                   // no room for the record (or it would overtake a dropped one)
+      }
+      else if (curCommandLen > 0) {      // check if we already stored some data
         recLenQueue.push(curCommandLen); // push the number of chars for this record 
+        Stats_QueueLevel(inpQueue.size(), recLenQueue.size());  // high-water marks
         curCommandLen = 0;               // new start
         pendingRec = recLenQueue.size();  // how many recrds
         stat_RX_LED = (stat_RX_LED != LOW)? LOW : HIGH;  // toggle the state
         digitalWrite(LED_RX, stat_RX_LED);   // toggle the RX LED
       }
     }
-    else if (inChar != '\r') {           // we throw away line CR characters, so if not CR we push char into FIFO
-      inpQueue.push(inChar);             // push the data into the FIFO
-      curCommandLen++;                   // one more pending char in the new sequence
+    else if ((inChar != '\r') && !rxLineDropped && (curCommandLen < COMMAND_STR_LEN)) {  // we throw away CR, the rest of a dropped line and what
+                                         // doesn't fit into commandStr (the line is reported too long) - so if not CR we push char into FIFO
+      if (inpQueue.isFull()) {
+        rxLineDropped = true;            // push() would overwrite the oldest command
+      }
+      else {
+        inpQueue.push(inChar);           // push the data into the FIFO
+        curCommandLen++;                 // one more pending char in the new sequence
+      }
     }
 
   } // data arrived on serial port
+  if (rxFlowMode == RX_FLOW_XON) {
+    RxFlow_XonXoff();
+  }
 
   inQueue = recLenQueue.size();
   
   if (stateMeasureZ == IDLE) // there are no active tasks going on - so we can try to poll a new command for execution
   {
-    if (inQueue > 0)  // there are pending commands - let's process them, notice that we pull only one command to ensure we don't stuck here
+    if (batchActive)  // we are in a ';' line - execute its next command (one per loop, the previous one may have been z or calibrate)
+    {
+      int batchCmndLen = Batch_NextCommand();   // next command into commandStr
+      if (batchCmndLen >= 0) {
+        if (CommandSplitter()) {         // the command tokens into sub0..sub4
+          Command_Processor();           // execute it - the delimiter is held back until the end of the batch
+        }
+      }
+      else {
+        Batch_Finish();                  // summary + the single delimiter
+      }
+    }
+    else if (inQueue > 0)  // there are pending commands - let's process them, notice that we pull only one command to ensure we don't stuck here
     {
       pendingRec = recLenQueue.shift();  // get out one record
 
-      for (int ii = 0; ii < pendingRec; ii++) {  // extract the next command from the circular FIFO
-        commandStr[ii] = inpQueue.shift();
+      if (pendingRec == 0) {             // the line was dropped on receive - it gets an error instead of its response
+        Bridge_SerialPrintLn("Error : input overflow - command dropped");
+        Bridge_SerialPrintDelimiter();
       }
-      commandStr[pendingRec] = char(0); // add string end
-
-      Bridge_SerialPrintLn(commandStr);       //echo - output the original string (if we need echo - uncomment this row)
-      CommandSplitter(pendingRec);      // split the commands into up to 5 fields, we pass the length of the available records and get arguments into sub0..4
+      else {
+        Command_Begin();
+        for (int ii = 0; ii < pendingRec; ii++) {  // extract the next command from the circular FIFO, the tokens are marked on the way
+          Command_AddChar(inpQueue.shift());
+        }
+        int lineLen = Command_End();      // add string end, -1 if the line didn't fit
 
-      Command_Processor();              // here we extract the commands and arguments and we send the data to SPI, in case we need to wait for some commands 
-                                        // like z or claibrate - we use the secondary processing in SecondaryCommandPorcessor()
+        Bridge_SerialPrintLn(commandStr);       //echo - output the original string (if we need echo - uncomment this row)
+        if ((lineLen >= 0) && (strchr(commandStr, BATCH_SEPARATOR) != NULL)) {  // several commands on the line - they run from the next loop on
+          Batch_Start(lineLen);
+        }
+        else if (CommandSplitter()) {       // sub0..sub4 point to the tokens of commandStr (too long line is reported here)
+          Command_Processor();              // here we extract the commands and arguments and we send the data to SPI, in case we need to wait for some commands 
+                                            // like z or claibrate - we use the secondary processing in SecondaryCommandPorcessor()
+        }
+      } // not dropped
     } // there were some pending command lines - we process them one by one to avoid locking the MCU in this place for long
   }  // no active task 
 
   ExecuteSlowTask();   // here we execute commands on regular intervals like wait for DONE and wait for MEASURE_DONE
 
+  Out_Service();       // what is left in the TX ring goes to USB if there is room (doesn't block)
+
 
 }  // end of the loop
 
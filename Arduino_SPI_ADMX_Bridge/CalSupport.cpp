@@ -8,10 +8,20 @@
 //================================================================
 #include <Arduino.h>
 #include <stdio.h>           // print commands and other stuff
+#include <math.h>            // fabs() for the frequency compare
 #include "SPI_cmnd.h"        // SPI commands definitions
 #include "ANSI_cmnd.h"      // ANSI commands definitions
 #include "CmndProcess.h"     // get some definitions from there
 #include "SlowTask.h"
+#include "SerialOut.h"       // numbers go straight into the TX ring
+#include "FastFormat.h"      // "%.7e" without sprintf()
+#include "CalSupport.h"      // calBlock_t
+#include "ShadowCache.h"     // loaded frequency without SPI read
+
+calIndexEntry_t calIndex[CAL_INDEX_SIZE];   // known calibrations, in the order they were found
+int  calIndexCount = 0;                     // used entries
+bool calIndexStale = true;                  // TRUE - the gain sets must be scanned before the next list
+bool calIndexTruncated = false;             // TRUE - the index was full and some sets were not kept
 
 //================================================================
 // Read calibration coefficients (double precision) for Vgain/Igain
@@ -33,7 +43,7 @@ double ReadCalibrationDouble(int addrVal, int V_gain, int I_gain, const char cus
   val_dbl = ConvInt64ToDouble(resultINT64);  // conversion to double
 
   Bridge_SerialPrint(custString); // this is the coefficient or other 
-  sprintf(floatBuffer, "%.7e", val_dbl);
+  FormatSci7(val_dbl, floatBuffer);
   Bridge_SerialPrintLn(floatBuffer);  // Output coeff
 
   return val_dbl;
@@ -56,7 +66,7 @@ float ReadCalibrationFloat(int addrVal, int V_gain, int I_gain, const char custS
 
   Bridge_SerialPrint(custString); // this is the coefficient or other 
 
-  sprintf(floatBuffer, "%.7e", val_float);
+  FormatSci7(val_float, floatBuffer);
   Bridge_SerialPrintLn(floatBuffer);  // Output coeff
  
   return val_float;
@@ -73,11 +83,198 @@ uint32_t ReadCalibrationUInt32(int addrVal, int V_gain, int I_gain, const char c
   resultINT32 = SingleParamReadWrite_waitDone(CMD_CAL_READ, MASK_LSB_COEFFICIENT | (addrVal << SHIFT_ADDR_READ_CAL) | \
                                                         ((I_gain & 0x03) << 2) | (V_gain & 0x03), 0, READ_MODE);  // Request reading Ro coeff LSB
   Bridge_SerialPrint(custString); // this is the coefficient or other 
-  Bridge_SerialPrintLn(String(resultINT32));  // Output coeff
+  Out_UInt(resultINT32);  // Output coeff
+  Bridge_SerialPrintLn();
  
   return resultINT32;
 
 } // end of ReadCalibrationUInt32(void)
 
+//================================================================
+// Read one calibration word - status + result only, no printing
+//================================================================
+static bool ReadCalibrationWord(int addrVal, int V_gain, int I_gain, uint16_t maskMSB, uint32_t *word)
+{
+  *word = SingleParamReadWrite_waitDone(CMD_CAL_READ, maskMSB | (addrVal << SHIFT_ADDR_READ_CAL) | \
+                                                        ((I_gain & 0x03) << 2) | (V_gain & 0x03), 0, READ_MODE);
+  return !flag_ERROR;
+}
+
+//================================================================
+// Read the whole calibration set of Vgain/Igain - status and the Ro probe first, so the
+// gains without coefficients cost two reads instead of 24 failing reads
+//================================================================
+bool ReadCalibrationBlock(int V_gain, int I_gain, calBlock_t *block)
+{
+  memset(block, 0, sizeof(calBlock_t));
+
+  if (!ReadCalibrationWord(CALL_ADDR_AC_STATUS, V_gain, I_gain, MASK_LSB_COEFFICIENT, &block->status)) {
+    return false;
+  }
+  // same test as <rdcal> - the status can be 0 for coefficients written by <storecal>, but Ro fails only if nothing is stored
+  if (!ReadCalibrationWord(CALL_ADDR_Ro, V_gain, I_gain, MASK_LSB_COEFFICIENT, &block->coeff[0])) {
+    block->coeff[0] = 0;
+    return true;   // no coefficients - not an error
+  }
+  block->hasCoeffs = true;
+
+  if (!ReadCalibrationWord(CALL_ADDR_AC_FREQ, V_gain, I_gain, MASK_LSB_COEFFICIENT, &block->freqBits) ||
+      !ReadCalibrationWord(CALL_ADDR_AC_TEMP, V_gain, I_gain, MASK_LSB_COEFFICIENT, &block->tempBits)) {
+    return false;
+  }
+
+  for (int ii = 0; ii < CAL_NUM_COEFFS; ii++) {   // coefficient ii is at address 2*ii (CALL_ADDR_Ro, CALL_ADDR_Xo...), Ro LSB is read already
+    if (((ii > 0) && !ReadCalibrationWord(CALL_ADDR_Ro + 2 * ii, V_gain, I_gain, MASK_LSB_COEFFICIENT, &block->coeff[2 * ii])) ||
+        !ReadCalibrationWord(CALL_ADDR_Ro + 2 * ii, V_gain, I_gain, MASK_MSB_COEFFICIENT, &block->coeff[2 * ii + 1])) {
+      return false;
+    }
+  }
+  return true;
+
+} // end of ReadCalibrationBlock()
+
+//================================================================
+// Calibration index - stale after commit/reload, empty after erase
+//================================================================
+void CalIndex_MarkStale(void)
+{
+  calIndexStale = true;
+}
+
+void CalIndex_Clear(void)
+{
+  calIndexCount = 0;
+  calIndexStale = true;
+  calIndexTruncated = false;
+}
+
+bool CalIndex_Truncated(void)
+{
+  return calIndexTruncated;
+}
+
+int CalIndex_Count(void)
+{
+  return calIndexCount;
+}
+
+const calIndexEntry_t *CalIndex_Entry(int index)
+{
+  return ((index >= 0) && (index < calIndexCount)) ? &calIndex[index] : NULL;
+}
+
+//================================================================
+// Position of the frequency/vgain/igain trinity in the index, calIndexCount if it is not there
+//================================================================
+static int CalIndex_Find(float freq, int V_gain, int I_gain)
+{
+  int ii;
+  for (ii = 0; ii < calIndexCount; ii++) {
+    if ((calIndex[ii].vgain == V_gain) && (calIndex[ii].igain == I_gain) &&
+        (fabs(calIndex[ii].freq - freq) <= CAL_FREQ_TOLERANCE * fabs(freq))) {
+      break;   // same trinity
+    }
+  }
+  return ii;
+}
+
+//================================================================
+// Put the trinity into the index - replace the old entry of the same frequency/vgain/igain
+//================================================================
+static void CalIndex_Update(float freq, int V_gain, int I_gain, uint32_t status, float temp)
+{
+  int ii = CalIndex_Find(freq, V_gain, I_gain);
+  if (ii == CAL_INDEX_SIZE) {
+    calIndexTruncated = true;   // full - the oldest entries are kept, the list says so
+    return;
+  }
+  if (ii == calIndexCount) {
+    calIndexCount++;
+  }
+  calIndex[ii].freq   = freq;
+  calIndex[ii].vgain  = V_gain;
+  calIndex[ii].igain  = I_gain;
+  calIndex[ii].status = (uint16_t)status;
+  calIndex[ii].temp   = temp;
+}
+
+//================================================================
+// Forget the trinity (resetcal + commit) - the order of the others is kept
+//================================================================
+static void CalIndex_Remove(float freq, int V_gain, int I_gain)
+{
+  int ii = CalIndex_Find(freq, V_gain, I_gain);
+  if (ii == calIndexCount) {
+    return;    // not known
+  }
+  calIndexCount--;
+  for (; ii < calIndexCount; ii++) {
+    calIndex[ii] = calIndex[ii + 1];
+  }
+}
+
+//================================================================
+// Scan the 16 gain sets of the loaded calibration - status, then freq/temp of the calibrated ones
+// a set with status 0 is not calibrated at the loaded (measurement) frequency any more
+//================================================================
+bool CalIndex_Refresh(void)
+{
+  uint32_t loadedFreqBits;
+
+  if (!calIndexStale) {
+    return true;   // nothing changed since the last scan
+  }
+  if (!Shadow_ReadParam(CMD_FREQUENCY, &loadedFreqBits, false, NULL)) {   // the module loads the calibration of this frequency
+    return false;
+  }
+
+  for (int gainIdx = 0; gainIdx < CAL_NUM_GAINS * CAL_NUM_GAINS; gainIdx++) {
+    int V_gain = gainIdx % CAL_NUM_GAINS;
+    int I_gain = gainIdx / CAL_NUM_GAINS;
+    uint32_t status, freqBits, tempBits;
 
+    if (!ReadCalibrationWord(CALL_ADDR_AC_STATUS, V_gain, I_gain, MASK_LSB_COEFFICIENT, &status)) {
+      return false;
+    }
+    if (status == 0) {
+      CalIndex_Remove(ConvInt32ToFloat(loadedFreqBits), V_gain, I_gain);   // e.g. after resetcal + commit
+      continue;    // not calibrated at this frequency
+    }
+    if (!ReadCalibrationWord(CALL_ADDR_AC_FREQ, V_gain, I_gain, MASK_LSB_COEFFICIENT, &freqBits) ||
+        !ReadCalibrationWord(CALL_ADDR_AC_TEMP, V_gain, I_gain, MASK_LSB_COEFFICIENT, &tempBits)) {
+      return false;
+    }
+    CalIndex_Update(ConvInt32ToFloat(freqBits), V_gain, I_gain, status, ConvInt32ToFloat(tempBits));
+  }
+
+  calIndexStale = false;
+  return true;
+
+} // end of CalIndex_Refresh()
+
+//================================================================
+// Index of the storecal token - the order of STORE_CAL_FIELDS1 is {R,X,G,B} x {o,s,g},
+// so the two chars give the index directly without comparing with all 12 tokens
+//================================================================
+int CalTokenIndex(const char token[])
+{
+  int kind, group;
 
+  switch (token[0]) {   // coefficient type
+    case 'R': kind = 0; break;
+    case 'X': kind = 1; break;
+    case 'G': kind = 2; break;
+    case 'B': kind = 3; break;
+    default: return -1;
+  }
+  switch (token[1]) {   // open/short/gain group
+    case 'o': group = 0; break;
+    case 's': group = 1; break;
+    case 'g': group = 2; break;
+    default: return -1;
+  }
+  if (token[2] != char(0)) {
+    return -1;          // longer than 2 chars
+  }
+  return group * 4 + kind;
+}
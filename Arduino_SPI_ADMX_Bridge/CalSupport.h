@@ -14,5 +14,36 @@
 double   ReadCalibrationDouble(int addrVal, int V_gain, int I_gain, const char custString[]);   // we read double data for Vgain/Igain
 float    ReadCalibrationFloat( int addrVal, int V_gain, int I_gain, const char custString[]);   // we read float data for Vgain/Igain
 uint32_t ReadCalibrationUInt32(int addrVal, int V_gain, int I_gain, const char custString[]);   // we read integer32 data for Vgain/Igain
+int      CalTokenIndex(const char token[]);   // position of Ro/Xo/Go/Bo/Rs...Bg in STORE_CAL_FIELDS1, -1 if not a token
 
-#endif  // end _CALIBRATE_SUPP_H
\ No newline at end of file
+//-------- Whole calibration set of one Vgain/Igain (rdcalall) - raw words as read from the module
+#define CAL_NUM_COEFFS        12      // Ro,Xo,Go,Bo, Rs,Xs,Gs,Bs, Rg,Xg,Gg,Bg - same order as STORE_CAL_FIELDS1
+#define CAL_NUM_GAINS          4      // Vgain and Igain are 0..3
+struct calBlock_t {
+  uint32_t status;                    // AC calibration status (short/open/load done)
+  bool     hasCoeffs;                 // FALSE - no coefficients stored (Ro can't be read, same test as <rdcal>), nothing else read
+  uint32_t freqBits;                  // calibration frequency (float)
+  uint32_t tempBits;                  // calibration temperature (float)
+  uint32_t coeff[2 * CAL_NUM_COEFFS]; // LSB, MSB word of every coefficient (double)
+};
+bool     ReadCalibrationBlock(int V_gain, int I_gain, calBlock_t *block);   // FALSE if a read failed (flag_ERROR/errorCodes tell why)
+
+//-------- Index of the known calibrations (calibrate list) - built from the status/freq/temp of the 16 gain sets
+// the module shows the sets of the loaded frequency only, so the sets of other frequencies are collected over reloads
+#define CAL_INDEX_SIZE        64      // frequency/vgain/igain trinities we remember
+#define CAL_FREQ_TOLERANCE    1e-6    // relative difference of frequencies treated as the same
+struct calIndexEntry_t {
+  float    freq;                      // calibration frequency in Hz
+  byte     vgain;
+  byte     igain;
+  uint16_t status;                    // short/open/load done masks
+  float    temp;                      // temperature during calibration
+};
+void     CalIndex_MarkStale(void);    // commit/reload - scan the sets again before the next list
+void     CalIndex_Clear(void);        // erase - nothing is stored any more
+bool     CalIndex_Refresh(void);      // scan if stale, FALSE if a read failed
+int      CalIndex_Count(void);
+bool     CalIndex_Truncated(void);    // TRUE - the index was full, some sets are missing from the list
+const calIndexEntry_t *CalIndex_Entry(int index);
+
+#endif  // end _CALIBRATE_SUPP_H
\ No newline at end of file
@@ -6,6 +6,17 @@
 // Written by Luben Hristov
 //
 // 12-08-24 -- Starting the impelementation
+// 17-10-26 -- Command table with binary search instead of the strcmp() chain
+// 17-10-26 -- Lean mode - warning codes are read only when the message is printed
+// 17-10-26 -- rdcalall - all calibration sets in one block
+// 17-10-26 -- calibrate list - answered from the calibration index
+// 17-10-26 -- sweep - range or list of frequencies without host round trips
+// 17-10-26 -- zstamp - sequence number, time and FIFO depth on the Z records
+// 17-10-26 -- stats - runtime counters
+// 17-10-26 -- trace - SPI frames ring, frozen on error/timeout
+// 17-10-26 -- latency - DONE wait uses the learned latency per command and backoff
+// 17-10-26 -- rxflow - receive flow control and free space
+// 17-10-26 -- status and the priority lane (abort/status/stats during z/calibrate)
 //================================================================
 #include <Arduino.h>
 #include <SPI.h>            // SPI functionality
@@ -13,7 +24,16 @@
 #include "SPI_cmnd.h"       // SPI commands definitions
 #include "ANSI_cmnd.h"      // ANSI commands definitions
 #include "CmndProcess.h"    // inlcude main functionality
+#include "Arduino_SPI_ADMX_Bridge.h"  // receive queues and flow control
 #include "CalSupport.h"     // main calibration coeff/data fetching commands are located here 
+#include "SlowTask.h"       // FIFO drain settings
+#include "ShadowCache.h"    // shadow copy of the parameters
+#include "SerialOut.h"      // TX ring buffer
+#include "FastFormat.h"     // "%.7e" of the calibration block
+#include "Sweep.h"          // bridge driven frequency sweep
+#include "Stats.h"          // runtime counters
+#include "Trace.h"          // SPI frame trace
+#include "Latency.h"        // learned DONE latency
 #include "LIF.h"            // include debugger interface
 
 //-------- VARIABLE definitions (allocate space )-----------------------------
@@ -21,10 +41,17 @@
         //floatResult = (*(float*)&resultA);  // this is working - convert the result straight into single precision floating 
 
 #define SPI_CLOCK_FREQ     8000000  // 8 MHz clock (but tested and working on 24 MHz)
-#define  COMMAND_STR_LEN       150  // what is the longest control string (whole line)
 char commandStr[COMMAND_STR_LEN];   // here we accumulate the data from the buffer and we have some limit of max len of string per line
 
-char sub0[SIZE_SUB_ARRAY], sub1[SIZE_SUB_ARRAY], sub2[SIZE_SUB_ARRAY], sub3[SIZE_SUB_ARRAY], sub4[SIZE_SUB_ARRAY];  // substring commands
+#define  MAX_TOKENS  (COMMAND_STR_LEN / 2)  // a token and its space take at least 2 chars
+int  commandLen = 0;                // chars in commandStr
+bool cmndTooLong = false;           // chars were thrown away - the line is reported as error
+bool inToken = false;               // the last char added was not a space
+int  numTokens = 0;                 // tokens of the line (the command and its arguments)
+byte tokStart[MAX_TOKENS];          // where the tokens start in commandStr
+byte tokEnd[MAX_TOKENS];            // where they end - CommandSplitter() puts the string end there
+char voidToken[1] = "";             // missing arguments point here
+char *sub0 = voidToken, *sub1 = voidToken, *sub2 = voidToken, *sub3 = voidToken, *sub4 = voidToken;  // the first 5 tokens (command + 4 arguments)
 
 // ----- Measuring Z global variables
 int measureZ_counter;             // keeps track of the sequential samples (when count > 1)
@@ -38,24 +65,171 @@ bool flag_FIFO_ERROR   ;  // set flag FIFO error
 int  depthFIFO         ;  // how many record reside in the FIFO
 int errorCodes         ;  // keep track of the error codes
 int warningCodes       ;  // keep track of warning codes
+bool leanMode = true   ;  // TRUE - warning codes are read only when the message is printed
+bool warningsPending = false;  // lean mode - WARN bit was set, but warningCodes were not read yet
+bool forceHwRead = false;  // TRUE - <param ?> the read goes to the module even if we have a shadow copy
+
+// ----- Batch (';' separated commands on one line)
+char batchLine[COMMAND_STR_LEN];   // the whole line, the commands are copied one by one into commandStr
+int  batchLen = 0;                 // length of batchLine
+int  batchPos = 0;                 // where the next command starts
+bool batchActive = false;          // TRUE while the commands of the line are executed
+int  batchCommands = 0;            // how many commands were started
+int  batchErrors = 0;              // error messages printed during the batch
+int  batchWarnings = 0;            // warning messages printed during the batch
+int  batchFailed[MAX_BATCH_FAILED]; // numbers (1..) of the commands which reported errors
+int  batchFailedCnt = 0;           // how many of them
 
+//================================================================
+// Count errors/warnings of the batch - every message starts with "Error" or "Warn"
+//================================================================
+void Batch_CountMessage(const char myStr[])
+{
+  if (!batchActive) {
+    return;   // normal single command
+  }
+  if (strncmp(myStr, "Error", 5) == 0) {
+    batchErrors++;
+    if ((batchFailedCnt == 0) || (batchFailed[batchFailedCnt-1] != batchCommands)) {  // list each command once
+      if (batchFailedCnt < MAX_BATCH_FAILED) {
+        batchFailed[batchFailedCnt++] = batchCommands;
+      }
+    }
+  }
+  else if (strncmp(myStr, "Warn", 4) == 0) {
+    batchWarnings++;
+  }
+}
 
 //================================================================
-void Bridge_SerialPrint(String myStr)  // as we define the Serial class in this file, we keep local vesrion of the Serial.print() here
+void Bridge_SerialPrint(const char myStr[])  // as we define the Serial class in this file, we keep local vesrion of the Serial.print() here
 {
-  Serial.print(myStr); 
+  Batch_CountMessage(myStr);   // errors and warnings are summarised at the end of a batch
+  Out_Str(myStr);              // into the TX ring - goes to USB with the rest of the response
 }
 
 //================================================================
-void Bridge_SerialPrintLn(String myStr) // as we define the Serial class in this file, we keep local vesrion of the Serial.printLn() here
+void Bridge_SerialPrintLn(const char myStr[]) // as we define the Serial class in this file, we keep local vesrion of the Serial.printLn() here
 {
-  Serial.println(myStr); 
+  Batch_CountMessage(myStr);   // errors and warnings are summarised at the end of a batch
+  Out_Str(myStr);
+  Out_Str("\r\n");             // same line end as Serial.println()
 }
 
 //================================================================
 void Bridge_SerialPrintDelimiter() // as we define the Serial class in this file, we keep local vesrion of the printing delimiter only
 {
-  Serial.print(DATA_DELIMITER);  // this is a special character to separate the data blocks (equivalent of ANSI ESC sequences )
+  if (batchActive) {
+    return;    // the commands of a batch share one delimiter - printed by Batch_Finish()
+  }
+  Out_Char(DATA_DELIMITER);  // this is a special character to separate the data blocks (equivalent of ANSI ESC sequences )
+  Out_Flush();               // the response is complete - send it in one go
+}
+
+//================================================================
+// Batch of ';' separated commands - executed back to back from loop(), one delimiter at the end
+// z/calibrate inside the batch finish in ExecuteSlowTask() before the next command starts
+//================================================================
+void Batch_Start(int lineLen)
+{
+  memcpy(batchLine, commandStr, lineLen);   // commandStr will be reused for the single commands
+  batchLine[lineLen] = char(0);
+  batchLen = lineLen;
+  batchPos = 0;
+  batchCommands = batchErrors = batchWarnings = batchFailedCnt = 0;
+  batchActive = true;
+}
+
+//================================================================
+int Batch_NextCommand(void)
+{
+  while (batchPos < batchLen) {
+    Command_Begin();
+    while ((batchPos < batchLen) && (batchLine[batchPos] != BATCH_SEPARATOR)) {
+      Command_AddChar(batchLine[batchPos++]);
+    }
+    batchPos++;   // skip the separator
+    int cmndLen = Command_End();
+
+    if (numTokens > 0) {   // ";;" or "; ;" - nothing to execute
+      batchCommands++;   // command number used in the summary
+      return cmndLen;
+    }
+  }
+  return -1;   // no more commands
+}
+
+//================================================================
+void Batch_Finish(void)
+{
+  batchActive = false;   // from here on messages and delimiter go out normally
+
+  Out_Str("batch = ");            // <batch = 5 commands, 1 errors, 0 warnings, failed 3>
+  Out_Int(batchCommands);
+  Out_Str(" commands, ");
+  Out_Int(batchErrors);
+  Out_Str(" errors, ");
+  Out_Int(batchWarnings);
+  Out_Str(" warnings");
+  if (batchFailedCnt > 0) {
+    Out_Str(", failed");
+    for (int ii = 0; ii < batchFailedCnt; ii++) {
+      Out_Char(' ');
+      Out_Int(batchFailed[ii]);
+    }
+  }
+  Out_Str("\r\n");
+  Bridge_SerialPrintDelimiter();   // the only delimiter of the whole line
+}
+
+//================================================================
+void Batch_Abort(void)
+{
+  batchActive = false;
+  batchPos = batchLen = 0;
+}
+
+//================================================================
+// Binary record - [SYNC][type][len][payload...][checksum], checksum is XOR of type, len and payload
+// the host finds the records by SYNC + len, text lines and DATA_DELIMITER never start with SYNC
+// everything after SYNC is byte stuffed - a float byte can't be taken for SYNC or DATA_DELIMITER
+//================================================================
+void Bridge_SerialWriteRecord(byte recType, const byte payload[], byte payloadLen)
+{
+  byte outBuf[BIN_OUT_CHUNK + 2];         // stuffed bytes, sent in chunks
+  int outLen = 0;
+  byte checksum = recType ^ payloadLen;   // start the checksum with the header fields
+
+  for (int ii = 0; ii < payloadLen; ii++) {
+    checksum ^= payload[ii];
+  }
+
+  outBuf[outLen++] = BIN_SYNC_BYTE;       // the only SYNC of the record
+  for (int ii = -2; ii <= payloadLen; ii++) {   // type, len, payload (little endian as in memory), checksum
+    byte val;
+    if (ii == -2) {
+      val = recType;
+    }
+    else if (ii == -1) {
+      val = payloadLen;
+    }
+    else if (ii == payloadLen) {
+      val = checksum;
+    }
+    else {
+      val = payload[ii];
+    }
+    if ((val == BIN_SYNC_BYTE) || (val == (byte)DATA_DELIMITER) || (val == BIN_ESC_BYTE)) {
+      outBuf[outLen++] = BIN_ESC_BYTE;
+      val ^= BIN_ESC_XOR;
+    }
+    outBuf[outLen++] = val;
+    if (outLen >= BIN_OUT_CHUNK) {
+      Out_Bytes(outBuf, outLen);
+      outLen = 0;
+    }
+  }
+  Out_Bytes(outBuf, outLen);
 }
 
 //================================================================
@@ -73,102 +247,139 @@ void InitialiseSPI(void)
 //  Single SPI transmission of 56 bytes for read/write
 //================================================================
 // this is one single SPI transmission - 56 bits - we can do it for reading and writing (reading result is into dat0..dat3)
-#define GAP_BETWEEN_BYTES 4   // how many microseconds to have between bytes
-#define SS_CLEARANCE_TIME 4   // gap between SS going low or high and first/last pulse
-#define GAP_BETWEEN_TRANSMISSIONS 40 // minimum time is 40 us
+// the timing comes from spiTiming, so it can be tuned at runtime with <spi_timing> command
+spiTiming_t spiTiming = {GAP_BETWEEN_BYTES, SS_CLEARANCE_TIME, GAP_BETWEEN_TRANSMISSIONS};   // start with the safe (original) profile
+unsigned long lastFrameEnd_us = 0;    // when SS went high after the last frame, the gap to the next frame is measured from here
 
 uint32_t Single_ADMX_Frame(byte command, uint16_t address, uint32_t dataOut)
 {
-byte dat0, dat1, dat2, dat3;  // local variables for reading the SPI data out 
+byte frameBuf[7] = {command,                         // command
+                    (byte)((address >> 8)  & 0xFF),  // address H
+                    (byte)( address        & 0xFF),  // address L
+                    (byte)((dataOut >> 24) & 0xFF),  // data 31..24 - dat0 comes back here
+                    (byte)((dataOut >> 16) & 0xFF),  // data 23..16 - dat1
+                    (byte)((dataOut >>  8) & 0xFF),  // data 15..8  - dat2
+                    (byte)( dataOut        & 0xFF)}; // data 7..0   - dat3
+
+  unsigned long sinceLastFrame = micros() - lastFrameEnd_us;   // the time spent outside already counts into the gap
+  if (sinceLastFrame < spiTiming.frameGap_us) {
+    delayMicroseconds(spiTiming.frameGap_us - sinceLastFrame);  // ensure we have enough gap between the 56 bit transmissions
+  }
 
-  delayMicroseconds(GAP_BETWEEN_TRANSMISSIONS);    // ensure we have enough gap between the 56 bit transmissions              
   digitalWrite(SPI_SS_PIN, LOW);        
-  delayMicroseconds(SS_CLEARANCE_TIME);                 
-
-  SPI.transfer(command                       );   // command
-  delayMicroseconds(GAP_BETWEEN_BYTES);  // byte gap               
-  SPI.transfer((byte)((address >> 8)  & 0xFF));   // address H
-  delayMicroseconds(GAP_BETWEEN_BYTES);                 
-  SPI.transfer((byte)( address        & 0xFF));   // address L
-  delayMicroseconds(GAP_BETWEEN_BYTES);  // byte gap                
-
-  dat0 = SPI.transfer((byte)((dataOut >> 24) & 0xFF));   // data 31..24 into dat0
-  delayMicroseconds(GAP_BETWEEN_BYTES);   // byte gap               
-  dat1 = SPI.transfer((byte)((dataOut >> 16) & 0xFF));   // data 23..16 into dat1
-  delayMicroseconds(GAP_BETWEEN_BYTES);   // byte gap               
-  dat2 = SPI.transfer((byte)((dataOut >>  8) & 0xFF));   // data 15..8  into dat2  
-  delayMicroseconds(GAP_BETWEEN_BYTES);   // byte gap               
-  dat3 = SPI.transfer((byte)( dataOut        & 0xFF));   // data 7..0   into dat3
-  
-  delayMicroseconds(SS_CLEARANCE_TIME);    // byte gap              
-  
+  if (spiTiming.ssClearance_us) {
+    delayMicroseconds(spiTiming.ssClearance_us);                 
+  }
+
+  if (spiTiming.byteGap_us == 0) {     // no gaps needed - the whole frame goes in one call
+    SPI.transfer(frameBuf, sizeof(frameBuf));
+  }
+  else {                               // byte by byte with gaps
+    for (int ii = 0; ii < (int)sizeof(frameBuf); ii++) {
+      frameBuf[ii] = SPI.transfer(frameBuf[ii]);
+      if (ii < (int)sizeof(frameBuf) - 1) {
+        delayMicroseconds(spiTiming.byteGap_us);  // byte gap
+      }
+    }
+  }
+
+  if (spiTiming.ssClearance_us) {
+    delayMicroseconds(spiTiming.ssClearance_us);
+  }
   digitalWrite(SPI_SS_PIN, HIGH);       
+  lastFrameEnd_us = micros();           // start of the gap for the next frame
+  Stats_Frame(command);
 
-  return ((uint32_t)(dat0 << 24) | (uint32_t)(dat1 << 16) | (uint32_t)(dat2 << 8) | dat3 ); // return the U32_t result
+  uint32_t dataIn = ((uint32_t)frameBuf[3] << 24) | ((uint32_t)frameBuf[4] << 16) | ((uint32_t)frameBuf[5] << 8) | frameBuf[6];
+  Trace_Frame(command, address, dataOut, dataIn, lastFrameEnd_us);   // nothing is done when the trace is not armed
+  if (command != CMD_STATUS_READ) {
+    Latency_Command(command, lastFrameEnd_us);   // the DONE latency is measured from here
+  }
+  return (dataIn); // return the U32_t result
+}
+
+//================================================================
+// TRUE if the next frame can start without waiting for the inter-frame gap
+//================================================================
+bool ADMX_FrameGapElapsed(void)
+{
+  return (micros() - lastFrameEnd_us) >= spiTiming.frameGap_us;
 }
 
 
 //================================================================
-// Splitting space delimited commands up to 5 substrings (extta spaces removed)
-// 12-08-2024 -- Tested and working
+// Command line into commandStr - the tokens are found while the chars are copied
+// 17-10-26 -- replaces the copying into sub0..sub4 arrays, any number of arguments
 //================================================================
-void CommandSplitter(int cmndLen)    
-{  // extract data from commandStr
-  int subInd = 0;      // substring index
-  int jj_sub = 0;
-  sub0[0] = sub1[0] = sub2[0] = sub3[0] = sub4[0] = char(0);  // set setring ends at the beginning, if not used will yield void string
+void Command_Begin(void)
+{
+  commandLen = 0;
+  numTokens = 0;
+  inToken = false;
+  cmndTooLong = false;
+}
 
-  commandStr[cmndLen] = ' ';  // add artificially a space to trigger the end
-  cmndLen++;                  // expand the array to include the new space char
+void Command_AddChar(char curChar)
+{
+  if (commandLen >= COMMAND_STR_LEN - 1) {   // no room for the char and the string end
+    cmndTooLong = true;
+    return;
+  }
+  if (curChar == ' ') {
+    if (inToken) {
+      tokEnd[numTokens - 1] = commandLen;    // end of the token (extra spaces are skipped)
+      inToken = false;
+    }
+  }
+  else if (!inToken) {                    // first char of a new token
+    tokStart[numTokens] = commandLen;        // can't run out - every token takes at least 2 chars of the line
+    tokEnd[numTokens] = commandLen + 1;
+    numTokens++;
+    inToken = true;
+  }
+  commandStr[commandLen++] = curChar;
+}
 
-  bool prevCharIsSpace = true;  // if we find two or more consective spaces, we throw 
-  for (int ii = 0; ii < cmndLen; ii++)  { 
+int Command_End(void)   // returns the length of the line, -1 if it didn't fit
+{
+  if (inToken) {
+    tokEnd[numTokens - 1] = commandLen;
+    inToken = false;
+  }
+  commandStr[commandLen] = char(0);
+  return cmndTooLong ? -1 : commandLen;
+}
 
-    char curChar = commandStr[ii];  // get the next char
-    if (curChar == ' ')   // found space ?
-    {
-      if (prevCharIsSpace == false) 
-      {  
-       // we have space, but the previous character was not space, so this is the end of the substring
-        switch (subInd) {  // store data into different subArrays
-          case 0: sub0[jj_sub] = char(0);  break; // add end of string
-          case 1: sub1[jj_sub] = char(0);  break; // add end of string
-          case 2: sub2[jj_sub] = char(0);  break; // add end of string
-          case 3: sub3[jj_sub] = char(0);  break; // add end of string
-          case 4: sub4[jj_sub] = char(0);  break; // add end of string
-          default: break;  // we shopuld not come here
-        } // check in which array to store end of string \0
-        subInd++;   // we'll store the data into the next substring 
-        if (subInd >= 5)
-          subInd = 5;    // limit the number of subscans to 6, where the only 5 are active (if subInd=5 we don't do anything)
-
-        prevCharIsSpace = true;
-        jj_sub = 0;
-      }
-      else // previous is also space, so we can remove this one
-      {  // we have two consecutive spaces - delete this one
-         // don't do anything - throw away the space
-      }
-    } // was space chacarter
-    else 
-    { // it's normal character (not space)
-      switch (subInd) {  // store data into different subArrays
-        case 0: sub0[jj_sub] = curChar;  break; 
-        case 1: sub1[jj_sub] = curChar;  break; 
-        case 2: sub2[jj_sub] = curChar;  break; 
-        case 3: sub3[jj_sub] = curChar;  break; 
-        case 4: sub4[jj_sub] = curChar;  break; 
-        default: break;
-      } // check in which array to store the strings
-
-      jj_sub++;                  // go to next sub 
-      prevCharIsSpace = false;   // it's not anymore space the previous character
-
-      if (jj_sub >= SIZE_SUB_ARRAY) // ensure we're not going beyond the array size
-        jj_sub = SIZE_SUB_ARRAY-1;  // limit the index - the line was too long
-
-    } // was normal char   
-  } // getting next character from the commandStr[]
+//================================================================
+// Token of the line - void string if there is no such
+//================================================================
+char *Command_Token(int index)
+{
+  return (index < numTokens) ? &commandStr[tokStart[index]] : voidToken;
+}
+
+//================================================================
+// Terminate the tokens in place and point sub0..sub4 at them (void string if not present)
+// a line which didn't fit is reported here - FALSE means don't process the command
+//================================================================
+bool CommandSplitter(void)
+{
+  if (cmndTooLong) {
+    Bridge_SerialPrintLn("Error : command line too long");
+    Bridge_SerialPrintDelimiter();
+    numTokens = 0;
+    sub0 = sub1 = sub2 = sub3 = sub4 = voidToken;
+    return false;
+  }
+  for (int ii = 0; ii < numTokens; ii++) {
+    commandStr[tokEnd[ii]] = char(0);     // commandStr is not one string any more
+  }
+  sub0 = Command_Token(0);
+  sub1 = Command_Token(1);
+  sub2 = Command_Token(2);
+  sub3 = Command_Token(3);
+  sub4 = Command_Token(4);
+  return true;
 } // end of <CommandSplitter>
 
 
@@ -182,7 +393,7 @@ void PrintErrWarnMessage(byte forCommand, const char custMsgStr[], const char ms
     Bridge_SerialPrint("Error : ");       // report the error string
     Bridge_SerialPrint(custMsgStr);       // report the custom error
     Bridge_SerialPrint(" / 0x");
-    Bridge_SerialPrint(String(forCommand, HEX));
+    Out_Hex(forCommand);
     Bridge_SerialPrint(" / ");            // end message - ad new line
     Bridge_SerialPrintLn(msgString);
    }
@@ -191,7 +402,7 @@ void PrintErrWarnMessage(byte forCommand, const char custMsgStr[], const char ms
     Bridge_SerialPrint("Warn : ");        // report the error string
     Bridge_SerialPrint(custMsgStr);       // report the custom error
     Bridge_SerialPrint(" / 0x");
-    Bridge_SerialPrint(String(forCommand, HEX));
+    Out_Hex(forCommand);
     Bridge_SerialPrint(" / ");
     Bridge_SerialPrintLn(msgString);      // end message - add new line
 
@@ -287,6 +498,7 @@ bool IsOK_Report_Err_Warn(const char custMessage[], byte custCommand)  // we can
    } // flag error was set
 
   if (flag_WARNING) {  // warning? We can have multiple warnings at once
+    FetchPendingWarnings();  // lean mode - the codes are read now, when we need the text
 
     if (warningCodes & DDS_NCO_FREQ_WARN ) {  // command failed
       strcpy(messageStr, "DDS & NCO Frequency are not equal warning");    
@@ -346,7 +558,11 @@ void CheckStatus_and_Warnings(void)
 {
   WaitForDoneAndGetStatus(1);  // read the status but don't wait - return immediately
 
-  if (flag_WARNING)  // let's pull the data from warning register, flagWarning was set before this
+  warningsPending = false;
+  if (flag_WARNING && leanMode) {  // IsOK_Report_Err_Warn() will read them
+    warningsPending = true;
+  }
+  else if (flag_WARNING)  // let's pull the data from warning register, flagWarning was set before this
   {
     Single_ADMX_Frame(CMD_WARNING_READ, 0, 0);  // initiate reading of the warning messages from status register
     WaitForDoneAndGetStatus();  // wait as long as needed to poll the status
@@ -355,6 +571,32 @@ void CheckStatus_and_Warnings(void)
 
 } // end of CheckStatus_and_Warnings(void)
 
+//================================================================
+// Lean mode - read the warning codes of the last command only when somebody needs them
+// the flags describe the command, not the warning read, so they are kept
+//================================================================
+void FetchPendingWarnings(void)
+{
+  if (!warningsPending) {
+    return;  // nothing to read, or already read
+  }
+  warningsPending = false;
+
+  bool keepDone    = flag_DONE;      // the warning read has its own status
+  bool keepError   = flag_ERROR;
+  bool keepWarning = flag_WARNING;
+  int  keepErrors  = errorCodes;
+
+  Single_ADMX_Frame(CMD_WARNING_READ, 0, 0);  // initiate reading of the warning messages from status register
+  WaitForDoneAndGetStatus();                  // we should not limit and wait till warnings are ready
+  warningCodes = Single_ADMX_Frame(CMD_RESULT_READ, 0, 0) & MASK_ALL_WARNING_MSG;
+
+  flag_DONE    = keepDone;
+  flag_ERROR   = keepError;
+  flag_WARNING = keepWarning;
+  errorCodes   = keepErrors;
+} // end of FetchPendingWarnings(void)
+
 //================================================================
 // SingleParamReadWrite_waitDone - read or write parameters from registers
 //================================================================
@@ -373,7 +615,12 @@ uint32_t SingleParamReadWrite_waitDone(byte command, uint16_t address, uint32_t
   } // end of reading
 
   warningCodes = 0;  // in case there are no warnings - we'll clear the flags
-  if (flag_WARNING)  // let's pull the data from warning register
+  warningsPending = false;
+  if (flag_WARNING && leanMode)  // fire and confirm - the codes are read by IsOK_Report_Err_Warn() if the text is printed
+  {
+    warningsPending = true;
+  }
+  else if (flag_WARNING)  // let's pull the data from warning register
   {
     Single_ADMX_Frame(CMD_WARNING_READ, 0, 0);  // initiate reading of the warning messages from status register
     currStatus = WaitForDoneAndGetStatus();     // we should not limit and wait till warnings are ready 
@@ -387,24 +634,65 @@ uint32_t SingleParamReadWrite_waitDone(byte command, uint16_t address, uint32_t
 //================================================================
 // Wait for Done status
 //================================================================
+// max_number_wait = 1 is a single status read (peek), nothing is waited or learned.
+// Otherwise with <latency on> we sleep most of the learned latency of the command, then poll
+// with a doubling gap till DONE or max_number_wait * DONE_POLL_BUDGET_US is over.
+// With <latency off> it's max_number_wait polls 25us apart like before.
 uint32_t WaitForDoneAndGetStatus(int max_number_wait)  // wait for status for some max amount of time
 {
   uint32_t currStatusVal = 0;  // var where we keep the last read status 
-  int ii;   // keep it external, so we can track how many times we wait in the loop
-  for (ii = 0; ii < max_number_wait; ii++)
+  bool learn = (max_number_wait > 1) && Latency_Armed();   // the wait right after a command frame
+  if (!learn) {
+    Latency_Disarm();          // a peek or a second wait - it doesn't measure the command
+  }
+  bool adaptive = latencyAdaptive && (max_number_wait > 1);
+  if (adaptive && learn) {
+    Latency_WaitExpected();    // no poll can see DONE before this
+  }
+
+  unsigned long startWait_us = micros();
+  unsigned long budget_us = (unsigned long)max_number_wait * DONE_POLL_BUDGET_US;
+  unsigned int pollGap_us = DONE_POLL_GAP_MIN_US;
+  bool timedOut = false;
+  int polls = 0;
+  while (true)
   {                            // notice that the SingleCommandFrame is taking ~20us and in total the loop period goes to 82us
  
                             // moving this delay after the Single_ADMX_Frame results is wrong data comming out!!!
     currStatusVal = Single_ADMX_Frame(CMD_STATUS_READ, 0, 0);   // only reads the status register
+    polls++;
     
     if (currStatusVal & ADMX200X_STATUS_DONE_BITM)  // is it done?
     {      
-      break;  // abort the for loop
+      if (learn) {
+        Latency_Done(lastFrameEnd_us);
+      }
+      break;  // abort the loop
     }  // we finally got the condition - flag DONE was set
 
-    delayMicroseconds(25);  // we need to bring some microseconds delay to avoid too offten polling of the status
-
+    if (adaptive) {
+      if (micros() - startWait_us >= budget_us) {
+        timedOut = true;
+        break;
+      }
+      delayMicroseconds(pollGap_us);  // backoff - the longer it takes, the less often we ask
+      if (pollGap_us < DONE_POLL_GAP_MAX_US) {
+        pollGap_us <<= 1;
+      }
+    }
+    else {
+      if (polls >= max_number_wait) {
+        timedOut = (max_number_wait > 1);   // a single poll is not a timeout
+        break;
+      }
+      delayMicroseconds(25);  // we need to bring some microseconds delay to avoid too offten polling of the status
+    }
   }
+  if (timedOut) {
+    Latency_Disarm();          // nothing learned, the command is still running
+    Trace_Trigger();           // DONE timeout - keep the frames around it
+  }
+  Stats_DoneWait(polls, timedOut);
 
   flag_DONE         = (currStatusVal  & ADMX200X_STATUS_DONE_BITM)?           true : false;  // set flag done
   
@@ -421,821 +709,1476 @@ uint32_t WaitForDoneAndGetStatus(int max_number_wait)  // wait for status for so
 
   flag_MEASURE_DONE = (currStatusVal  & ADMX200X_STATUS_MEASURE_DONE_BITM)? true : false;  // set flag measure done
   flag_FIFO_ERROR   = (currStatusVal  & ADMX200X_STATUS_FIFO_ERROR_BITM)?   true : false;  // set flag FIFO error
-  depthFIFO         = ((currStatusVal & ADMX200X_STATUS_FIFO_DEPTH_BITM) >> 16) & 0xFF;    // set number of records in FIFO
+  depthFIFO         = (currStatusVal & ADMX200X_STATUS_FIFO_DEPTH_BITM) >> 16;             // set number of records in FIFO (10 bits, up to 1023 words)
 
   return (currStatusVal);   // the last value of the status register is held here
 
 }
 
 //================================================================
-// Main processing of commands - we send SPI commands according to the ANSI commands strings in sub0..sub5
+// Enum argument (like <sweep_scale log>) - the value is the position of the name in the table, -1 if not found
 //================================================================
-void Command_Processor(void)
+int FindEnumValue(const cmndEntry_t *cmnd, const char argStr[])
 {
-    float floatResult;                        // temp variable for float data
-    float arg1, arg2;                         // keeps track of command arguments sent by the user
-    uint32_t resultA, resultB, resultC;       // temp data 
-    uint32_t statusA;                         // vars ysed in the code
-
-    bool flagGroupProcess = true;             // TRUE if we process group of commands which have something in common (like frequency, count, sweep_scale)
-    byte grCommand;                           // the command we send to SPI
-    enum argum_t { FLOAT_T, INT_T, ENUM_T };  // the type of conversion
-    argum_t argumentTypeRd = INT_T;          // what is the exact type of conversion for reading
-    argum_t argumentTypeWr = INT_T;          // what is the exact type of conversion for reading
-    
-    uint32_t enumValue;                       // some commands require conversion of char[] arguments to int, here we keep the value to write
-    bool enumError = false;                   // TRUE if it was not found a corresponding string in sub1 for the enum argument 
-    char pos_String[SIZE_SUB_ARRAY] = "";     // pos_string the response may inlcude some string like kHz, V, etc.   
-    float scaling = 1;                        // Frequency requires some scaling factor when reporting the value
-    char enumStr0[SIZE_SUB_ARRAY] = "";       // string for VAL=0 some sommands retrun verbose response like sweep_scale: linear/log
-    char enumStr1[SIZE_SUB_ARRAY] = "";       // string for VAL=0 some sommands retrun verbose response like sweep_scale: linear/log
-    char enumStr2[SIZE_SUB_ARRAY] = "";       // string for VAL=0 some sommands retrun verbose response like sweep_scale: linear/log
-    char enumStr3[SIZE_SUB_ARRAY] = "";       // string for VAL=0 some sommands retrun verbose response like sweep_scale: linear/log
-
-//--------- the following commands will be processed in the same way, we need to extract arguments and select float/INT32/enum type of data and enumVal
-  if(strcmp(sub0, FREQUENCY0) == 0) {
-    argumentTypeRd = FLOAT_T;
-    argumentTypeWr = FLOAT_T;
-    grCommand = CMD_FREQUENCY;  // this is the short byte SPI command
-    strcpy(pos_String, FREQUENCY_POS_STR);  // what to display after the value
-    scaling = 1000;
-  } 
-  else if(strcmp(sub0, MAGNITUDE0) == 0) {
-    argumentTypeRd = FLOAT_T;
-    argumentTypeWr = FLOAT_T;
-    grCommand = CMD_MAGNITUDE;  // this is the short byte SPI command
-  //  strcpy(pos_String, MAGNITUDE_POS_STR);  // don't show the volts
-  }
-  else if(strcmp(sub0, OFFSET0) == 0) {
-    argumentTypeRd = FLOAT_T;
-    argumentTypeWr = FLOAT_T;
-    grCommand = CMD_OFFSET;  // this is the short byte SPI command
-  //  strcpy(pos_String, OFFSET_POS_STR);  // don't show the volts
-  }
-  else if(strcmp(sub0, AVERAGE0) == 0) {
-    grCommand = CMD_AVERAGE;  // this is the short byte SPI command, default is int
-  }
-  else if(strcmp(sub0, DISPLAY0) == 0) {
-    grCommand = CMD_DISPLAY;  // this is the short byte SPI command, default is int
-  }
-  else if(strcmp(sub0, MDELAY0) == 0) {
-    argumentTypeRd = FLOAT_T;
-    argumentTypeWr = FLOAT_T;
-    grCommand = CMD_MDELAY;  // this is the short byte SPI command, default is int
-    strcpy(pos_String, MDELAY_POS_STR);  // what to display after the value
-  }
-  else if(strcmp(sub0, TDELAY0) == 0) {
-    argumentTypeRd = FLOAT_T;
-    argumentTypeWr = FLOAT_T;
-    grCommand = CMD_TDELAY;  // this is the short byte SPI command, default is int
-    strcpy(pos_String, TDELAY_POS_STR);  // what to display after the value
-  }
-  else if(strcmp(sub0, COUNT0) == 0) {
-    grCommand = CMD_COUNT;  // this is the short byte SPI command, default is int
-  }
-  else if(strcmp(sub0, TCOUNT0) == 0) {
-    grCommand = CMD_TCOUNT;  // this is the short byte SPI command, default is int
-  }
-  else if(strcmp(sub0, TEMPERAT0) == 0) {
-    //-------- TEMPERATURE ENUM CONVERSION ---------------
-    argumentTypeRd = FLOAT_T;
-    argumentTypeWr = ENUM_T;
-    strcpy(enumStr0, TEMP_CELSIUS);    // verbose reponses for 0
-    strcpy(enumStr1, TEMP_FARENHEIT);  // verbose reponses for 1
-
-    if(strcmp(sub1, TEMP_CELSIUS) == 0) {
-      enumValue = TEMP_CELSIUS_VAL;
-      grCommand = CMD_CELSIUS;       // set units   
-    } // celsius
-    else if (strcmp(sub1, TEMP_FARENHEIT) == 0) {
-      enumValue = TEMP_FARENHEIT_VAL; 
-      grCommand = CMD_CELSIUS;       // set units   
-    } // farenheit
-    else if (strcmp(sub1, VOID_STR) == 0) {
-        grCommand = CMD_TEMPERATURE;       // this is the short byte SPI command for reading temperature
-       }// READ command - avoid setting the error
-    else {
-      enumError = true;  // we can't find the corresponding enum and we rise the error    
-    }
-  }
-  else if(strcmp(sub0, TRIG_MODE0) == 0) {
-    //-------- TRIGGER MODE ENUM CONVERSION ---------------
-    argumentTypeRd = ENUM_T;
-    argumentTypeWr = ENUM_T;
-    grCommand = CMD_TRIGGER_MODE;     // this is the short byte SPI command
-    strcpy(enumStr0, TRIG_MODE_INT);  // verbose reponses for 0
-    strcpy(enumStr1, TRIG_MODE_EXT);  // verbose reponses for 1
-
-     if(strcmp(sub1, TRIG_MODE_INT) == 0) {
-      enumValue = TRIG_MODE_INTER_VAL;
-    } // internal trigger mode
-    else if (strcmp(sub1, TRIG_MODE_EXT) == 0) {
-      enumValue = TRIG_MODE_EXTERN_VAL;    
-    } // external trigger mode
-    else if (strcmp(sub1, VOID_STR) == 0) {   }// READ command - avoid setting the error
-    else {
-      enumError = true;  // we can't find the corresponding enum and we rise the error    
-    }
-  }
-//-------- SET GPIO ---------------
-  else if(strcmp(sub0, GPIO_CTRL0) == 0) {
-    argumentTypeRd = INT_T;
-    argumentTypeWr = INT_T;
-    grCommand = CMD_SET_GPIO;  // this is the short byte SPI command
-  //  strcpy(pos_String, OFFSET_POS_STR);  // don't show the volts
-  }
-
-  else if(strcmp(sub0, SWEEP_SCALE0) == 0) {
-    //-------- SWEEP SCALE ENUM CONVERSION ---------------
-    argumentTypeRd = ENUM_T;
-    argumentTypeWr = ENUM_T;
-    grCommand = CMD_SWEEP_SCALE;  // this is the short byte SPI command
-    strcpy(enumStr0, SWEEP_SCALE_LIN1);  // verbose reponses for 0
-    strcpy(enumStr1, SWEEP_SCALE_LOG1);  // verbose reponses for 1
-
-   if(strcmp(sub1, SWEEP_SCALE_LIN1) == 0) {
-      enumValue = SWEEP_SCALE_LIN_VAL;
-    } // linear scale
-    else if (strcmp(sub1, SWEEP_SCALE_LOG1) == 0) {
-      enumValue = SWEEP_SCALE_LOG_VAL;    
-    } // log scale
-    else if (strcmp(sub1, VOID_STR) == 0) {   }// READ command - avoid setting the error
-    else {
-      enumError = true;  // we can't find the corresponding enum and we rise the error    
-    } // was wrong
-  } // end of sweep scale
-  else if(strcmp(sub0, SWEEPTYPE0) == 0) {
-    //-------- SWEEP TYPE ENUM CONVERSION ---------------
-    argumentTypeRd = ENUM_T;  // read will require enum
-    argumentTypeWr = ENUM_T;  // write will require enum
-    grCommand = CMD_SWEEP_TYPE;           // this is the short byte SPI command
-    strcpy(enumStr0, SWEEPTYPE_OFF1);     // verbose reponses for 0
-    strcpy(enumStr1, SWEEPTYPE_FREQ1);    // verbose reponses for 1
-    strcpy(enumStr2, SWEEPTYPE_MAGN1);    // verbose reponses for 2
-    strcpy(enumStr3, SWEEPTYPE_OFFSET1);  // verbose reponses for 3
-  
-    if (strcmp(sub1, SWEEPTYPE_OFF1) == 0) {  // enum = 0
-      enumValue = 0;    
-    } // off
-    else if(strcmp(sub1, SWEEPTYPE_FREQ1) == 0) {  // case 1
-      enumValue = 1;
-    } // freq
-    else if (strcmp(sub1, SWEEPTYPE_MAGN1) == 0) {  // case 2
-      enumValue = 2;    
-    } // magnitude
-    else if (strcmp(sub1, SWEEPTYPE_OFFSET1) == 0) {  // case 3
-      enumValue = 3;     
-    } // offset
-    else if (strcmp(sub1, VOID_STR) == 0) {   }// READ command - avoid setting the error
-    else {
-      enumError = true;  // we can't find the corresponding enum and we rise the error    
+  for (int ii = 0; ii < MAX_CMND_ENUMS; ii++) {
+    if ((cmnd->enumStr[ii] != NULL) && (strcmp(argStr, cmnd->enumStr[ii]) == 0)) {
+      return ii;
     }
   }
-  else
-  { // it's not group command - we'll proceed with what's left
-    flagGroupProcess = false;
-  }
-
+  return -1;
+}
 
-//-------- GROUP PROCESSING OF COMMANDS like frequency/magnitude/count/sweep_type
-  if (flagGroupProcess)
-  {
-    //===================================================================
-    //  READ MULTIPLE COMMANDS (like freq/magn/offset/count... etc.)
-    //===================================================================
-    if (strcmp(sub1, VOID_STR) == 0) // READ command 
-    {  
-      resultA = SingleParamReadWrite_waitDone(grCommand | CMND_READ_MASK, 0, 0, READ_MODE); // read parameter 
- 
-      if (IsOK_Report_Err_Warn("Hardware error1", grCommand | CMND_READ_MASK))   // check if no warnings and errors
-      { 
-        Bridge_SerialPrint(sub0);     // the command name
-        Bridge_SerialPrint(" = ");    // the command name
-
-        switch(argumentTypeRd) {
-          case FLOAT_T : {
-            floatResult = ConvInt32ToFloat(resultA) / scaling;        // convert the result straight into single precision floating  and divide by 1000 (kHz)
-            Bridge_SerialPrint(String(floatResult, 4));                     // report the response as floating point
-            Bridge_SerialPrintLn(pos_String);                               // add the pos string at the end
-            break;
-          } // end FLOAT_T
-
-          case INT_T   : {
-            Bridge_SerialPrint(String(resultA));                            // report the response as integer
-            Bridge_SerialPrintLn(pos_String);                               // add the pos string at the end
-            break;
-          } // end INT_T
-
-          case ENUM_T  : {
-            switch (resultA) {  // switch on different enum responses (up to 4)
-              case 0: Bridge_SerialPrintLn(enumStr0); break;                // report the response as verbose
-              case 1: Bridge_SerialPrintLn(enumStr1); break;                // report the response as verbose
-              case 2: Bridge_SerialPrintLn(enumStr2); break;                // report the response as verbose
-              case 3: Bridge_SerialPrintLn(enumStr3); break;                // report the response as verbose
-              default: Bridge_SerialPrintLn("Error : Can't find enum"); break;  // we should never come here
-            } // end of switch
-          } // end ENUM_T
-        }
+//================================================================
+// Parameters read/written in the same way (frequency/magnitude/count/sweep_type...)
+// the conversion, scaling, post string and enum names come from the command table
+//================================================================
+void Cmnd_Param(const cmndEntry_t *cmnd)
+{
+  float floatResult;                        // temp variable for float data
+  float arg1 = 0, arg2;                     // keeps track of command arguments sent by the user (arg1 is reported for FLOAT_T only)
+  uint32_t resultA = 0;                     // temp data
 
-        Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as delimiter for the commands
+  //===================================================================
+  //  READ MULTIPLE COMMANDS (like freq/magn/offset/count... etc.)
+  //===================================================================
+  if (strcmp(sub1, VOID_STR) == 0) // READ command 
+  {  
+    if (Shadow_ReadParam(cmnd->rdOpcode, &resultA, forceHwRead, "Hardware error1"))   // read parameter (shadow copy if we have it), check if no warnings and errors
+    { 
+      Bridge_SerialPrint(sub0);     // the command name
+      Bridge_SerialPrint(" = ");    // the command name
 
-      }  // was no error and DONE OK  
-    } // end of read multiple commands (like freq/magnit/offset,)
-    else
-    {  
-    //===================================================================
-    // WRITE MULTIPLE COMMANDS (like freq/magn/offset/count... etc.)
-    //===================================================================
-      switch(argumentTypeWr) {
+      switch(cmnd->typeRd) {
         case FLOAT_T : {
-          arg1 = atof(sub1);  // this is the extracted value as float from argument1 
-          arg2 = arg1 * scaling;  // in case of frequency registers accept Hz, not kHz and we need scaling
-          resultA = ConvFloatToInt32(arg2);
+          floatResult = ConvInt32ToFloat(resultA) / cmnd->scaling;    // convert the result straight into single precision floating  and divide by 1000 (kHz)
+          Out_Float(floatResult, 4);                     // report the response as floating point
+          Bridge_SerialPrintLn(cmnd->posStr);                             // add the pos string at the end
           break;
         } // end FLOAT_T
 
         case INT_T   : {
-          resultA = atoi(sub1);  // this is the extracted value as integer from argument1 
+          Out_UInt(resultA);                            // report the response as integer
+          Bridge_SerialPrintLn(cmnd->posStr);                             // add the pos string at the end
           break;
         } // end INT_T
 
         case ENUM_T  : {
-          resultA = enumValue;  // this is the extracted value as integer from enum
-          break;
-        } // end ENUM_T
-      }  // end of switch statement
-
-      if (enumError == false)  { // no error 
-        SingleParamReadWrite_waitDone( grCommand, 0, resultA, WRITE_MODE);  // write the value
-        if (IsOK_Report_Err_Warn("Wrong arguments", grCommand))   // check if no warnings and errors
-        { 
-          Bridge_SerialPrint(sub0);     // the command name
-          Bridge_SerialPrint(" = ");    // equals
-          if (argumentTypeWr == FLOAT_T) {
-            Bridge_SerialPrint(String(arg1, 4));   // report the float response
-            Bridge_SerialPrintLn(pos_String);      // add pos string if any
+          if ((resultA < MAX_CMND_ENUMS) && (cmnd->enumStr[resultA] != NULL)) {
+            Bridge_SerialPrintLn(cmnd->enumStr[resultA]);                 // report the response as verbose
           }
           else {
-            Bridge_SerialPrint(String(resultA));  // report the integer response
-            Bridge_SerialPrintLn(pos_String);      // add pos string if any
+            Bridge_SerialPrintLn("Error : Can't find enum");              // we should never come here
           }
-        }
-      }
-      else { // there is enum erro!
-        Bridge_SerialPrintLn("Error : Wrong enum argument");
+        } // end ENUM_T
       }
 
-      Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands        
-    }  // was write multiple
-  } // was group processing
-
-//===================================================================
-//
-//*******************************************************************
-// SINGLE INDIVIDUAL COMMANDS which need special treatment
-//*******************************************************************
-//
-//===================================================================
-  else { // not group processing but ordinary commands
-    
- //===================================================================
-  // GET DEVICE IDN  (*idn? command)
-  //===================================================================
-    if(strcmp(sub0, IDN0) == 0)  // get device IDN command
-    { 
-    char outputString[9];  // temp string for HEX values
-
-  //--------- Read the firmware revision
-      resultA = SingleParamReadWrite_waitDone(CMD_FW_VERSION, 0, 0, READ_MODE);
-      if (IsOK_Report_Err_Warn("Hardware error2", CMD_FW_VERSION)) {
-        Bridge_SerialPrint("ADMX2001 - Precision Impedance Analyzer Measurement Module ");     // add pos string if any
-        Bridge_SerialPrint(String((resultA >> 24) & 0xFF));     // add pos string if any
-        Bridge_SerialPrint(".");     // add pos string if any
-        Bridge_SerialPrint(String((resultA >> 16) & 0xFF));     // add pos string if any
-        Bridge_SerialPrint(".");     // add pos string if any
-        Bridge_SerialPrintLn(String((resultA >> 8) & 0xFF));      // add pos string if any
-      }   // check if no warnings and errors
-
-  //--------- Read the unique ID number of the board
-      resultA = SingleParamReadWrite_waitDone(CMD_UNIQUE_ID, 1, 0, READ_MODE);  // MSB
-      if (IsOK_Report_Err_Warn("Hardware error3", CMD_UNIQUE_ID)) {  
-        Bridge_SerialPrint("Board ID - 0x");     // add pos string if any
-        sprintf(outputString,"%08X", resultA);    
-        Bridge_SerialPrint(outputString);     // add pos string if any
-      }   // check if no warnings and errors
-
-      resultA = SingleParamReadWrite_waitDone(CMD_UNIQUE_ID, 0, 0, READ_MODE);  // LSB
-      if (IsOK_Report_Err_Warn("Hardware error4", CMD_UNIQUE_ID)) {
-        sprintf(outputString,"%08X", resultA);    
-        Bridge_SerialPrintLn(outputString);     // add pos string if any
-      }   // check if no warnings and errors
-
       Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as delimiter for the commands
 
-    } // was *idn? command
+    }  // was no error and DONE OK  
+  } // end of read multiple commands (like freq/magnit/offset,)
+  else
+  {  
   //===================================================================
-  // RESET BOARD  (reset command)
+  // WRITE MULTIPLE COMMANDS (like freq/magn/offset/count... etc.)
   //===================================================================
-    else if(strcmp(sub0, RESET0) == 0)  // send reset command
-    { 
-
-  //--------- Reset
-      SingleParamReadWrite_waitDone(CMD_RESET, 0, 0, WRITE_MODE);
-      delay(80);   // for time <50ms the DONE flag is not set, need longer time
-      WaitForDoneAndGetStatus();  // wait till DONE was set
-      if (IsOK_Report_Err_Warn("Hardware error5", CMD_RESET)) {
-        Bridge_SerialPrintLn("Reset : success");     // reset was successful
-        Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as delimiter for the commands
-      }   // check if no warnings and errors
+    bool enumError = false;   // TRUE if it was not found a corresponding string in sub1 for the enum argument 
+
+    switch(cmnd->typeWr) {
+      case FLOAT_T : {
+        arg1 = atof(sub1);  // this is the extracted value as float from argument1 
+        arg2 = arg1 * cmnd->scaling;  // in case of frequency registers accept Hz, not kHz and we need scaling
+        resultA = ConvFloatToInt32(arg2);
+        break;
+      } // end FLOAT_T
+
+      case INT_T   : {
+        resultA = atoi(sub1);  // this is the extracted value as integer from argument1 
+        break;
+      } // end INT_T
+
+      case ENUM_T  : {
+        int enumValue = FindEnumValue(cmnd, sub1);  // the enum value is the position of the name in the table
+        enumError = (enumValue < 0);
+        resultA = enumValue;
+        break;
+      } // end ENUM_T
+    }  // end of switch statement
+
+    if (enumError == false)  { // no error 
+      SingleParamReadWrite_waitDone(cmnd->wrOpcode, 0, resultA, WRITE_MODE);  // write the value
+      Shadow_NoteWrite(cmnd->wrOpcode, resultA);  // keep the value in the shadow copy (forgotten on error/warning)
+      if (IsOK_Report_Err_Warn("Wrong arguments", cmnd->wrOpcode))   // check if no warnings and errors
+      { 
+        Bridge_SerialPrint(sub0);     // the command name
+        Bridge_SerialPrint(" = ");    // equals
+        if (cmnd->typeWr == FLOAT_T) {
+          Out_Float(arg1, 4);   // report the float response
+          Bridge_SerialPrintLn(cmnd->posStr);    // add pos string if any
+        }
+        else {
+          Out_UInt(resultA);   // report the integer response
+          Bridge_SerialPrintLn(cmnd->posStr);    // add pos string if any
+        }
+      }
     }
-  //===================================================================
-  // VOID COMMAND  - used for debugging the protocol
-  //===================================================================
-    else if(strcmp(sub0, CMND_VOID) == 0)  // send reset command
-    { 
-      // we just send back the response, no errors, we can accept up to 4 parameters   
-      Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as delimiter for the commands
-    }  //was void command
- 
-  //===================================================================
-  // ABORT MEASUREMENTS  (abort command)
-  //===================================================================
-    else if(strcmp(sub0, ABORT0) == 0)  // abort command
-    { 
-
-  //--------- Abort 
-      SingleParamReadWrite_waitDone(CMD_ABORT, 0, 0, WRITE_MODE);    // abort
-
-      if (IsOK_Report_Err_Warn("Hardware error6", CMD_ABORT)) {
-      }   // check if no warnings and errors
+    else { // there is enum erro!
+      Bridge_SerialPrintLn("Error : Wrong enum argument");
     }
 
-  //===================================================================
-  // MEASURE IMPEDANCE Z  (z command)
-  //===================================================================
-    else if(strcmp(sub0, MEAS_Z0) == 0)  // measure impedance Z
-    { 
-
-      SingleParamReadWrite_waitDone(CMD_Z, 0, 0, WRITE_MODE, 1);    // start Z measurement, don't wait too long, just ones
-      // we're not waiting for DONE here!
-      measureZ_counter = 0;                   // counter for sequential measurements (if count > 1)
-      stateMeasureZ    = ACTIVE_Z;            // changing the state to active will trigger a chain of events to poll multiple times the Z result
+    Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands        
+  }  // was write multiple
+} // end of <Cmnd_Param>
 
-    } // was Z measure impedance
+//================================================================
+// GET DEVICE IDN  (*idn? command)
+//================================================================
+void Cmnd_Idn(const cmndEntry_t *cmnd)
+{
+  uint32_t resultA;      // temp data
+  char outputString[9];  // temp string for HEX values
 
-  //===================================================================
-  // CALIBRATE command tug (calibrate splits into multiple branches) 
-  //===================================================================
-    else if(strcmp(sub0, CALIBRATE0) == 0)  // calibrate main tug is here
-    { 
-      measureZ_counter = 0;                   // counter for sequential measurements - in all cases we need to reset it, let's do it here
-      bool flagCalError = true;               // error flag to report if something went wrong
+  //--------- Read the firmware revision
+  resultA = SingleParamReadWrite_waitDone(CMD_FW_VERSION, 0, 0, READ_MODE);
+  if (IsOK_Report_Err_Warn("Hardware error2", CMD_FW_VERSION)) {
+    Bridge_SerialPrint("ADMX2001 - Precision Impedance Analyzer Measurement Module ");     // add pos string if any
+    Out_UInt((resultA >> 24) & 0xFF);     // add pos string if any
+    Bridge_SerialPrint(".");     // add pos string if any
+    Out_UInt((resultA >> 16) & 0xFF);     // add pos string if any
+    Bridge_SerialPrint(".");     // add pos string if any
+    Out_UInt((resultA >> 8) & 0xFF);      // add pos string if any
+    Bridge_SerialPrintLn();
+  }   // check if no warnings and errors
 
-      // first task is to read the current Vgain and Igain as FREQ/GVAIN/IGAIN is the calibration "trinity" defining the CAL_INDEX
+  //--------- Read the unique ID number of the board
+  resultA = SingleParamReadWrite_waitDone(CMD_UNIQUE_ID, 1, 0, READ_MODE);  // MSB
+  if (IsOK_Report_Err_Warn("Hardware error3", CMD_UNIQUE_ID)) {  
+    Bridge_SerialPrint("Board ID - 0x");     // add pos string if any
+    sprintf(outputString,"%08X", resultA);    
+    Bridge_SerialPrint(outputString);     // add pos string if any
+  }   // check if no warnings and errors
+
+  resultA = SingleParamReadWrite_waitDone(CMD_UNIQUE_ID, 0, 0, READ_MODE);  // LSB
+  if (IsOK_Report_Err_Warn("Hardware error4", CMD_UNIQUE_ID)) {
+    sprintf(outputString,"%08X", resultA);    
+    Bridge_SerialPrintLn(outputString);     // add pos string if any
+  }   // check if no warnings and errors
+
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as delimiter for the commands
+} // end of <Cmnd_Idn>
 
-      //------------ CALIBRATE SHORT ---------------------------------------
-      if (strcmp(sub1, CALIBRATE_SHORT1 ) == 0) {   // we start calibrate short
-        SingleParamReadWrite_waitDone(CMD_CALIBRATE, ADDRESS_SHORT_CAL, 0, WRITE_MODE);  // SHORT calibration is initiated
-        stateMeasureZ    = ACTIVE_CAL;    // changing the state to ACTIVE_CAL will trigger a chain of events to poll multiple times the CAL results
-        flagCalError = false; // no error
-        measureZ_counter = 0; // to display the result
+//================================================================
+// RESET BOARD  (reset command)
+//================================================================
+void Cmnd_Reset(const cmndEntry_t *cmnd)
+{
+  //--------- Reset
+  Shadow_InvalidateAll();     // module goes back to its defaults
+  CalIndex_MarkStale();       // and loads its calibration again
+  SingleParamReadWrite_waitDone(CMD_RESET, 0, 0, WRITE_MODE);
+  delay(80);   // for time <50ms the DONE flag is not set, need longer time
+  WaitForDoneAndGetStatus();  // wait till DONE was set
+  if (IsOK_Report_Err_Warn("Hardware error5", CMD_RESET)) {
+  Bridge_SerialPrintLn("Reset : success");     // reset was successful
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as delimiter for the commands
+  }   // check if no warnings and errors
+} // end of <Cmnd_Reset>
 
-      }
-      //------------ CALIBRATE OPEN ---------------------------------------
-      else if (strcmp(sub1, CALIBRATE_OPEN1 ) == 0) {   // we start calibrate open
-        SingleParamReadWrite_waitDone(CMD_CALIBRATE, ADDRESS_OPEN_CAL, 0, WRITE_MODE);  // OPEN calibration is initiated
-        stateMeasureZ    = ACTIVE_CAL;    // changing the state to ACTIVE_CAL will trigger a chain of events to poll multiple times the CAL results
-        flagCalError = false; // no error
-        measureZ_counter = 0; // to display the result
+//================================================================
+// VOID COMMAND  - used for debugging the protocol
+//================================================================
+void Cmnd_Void(const cmndEntry_t *cmnd)
+{
+  // we just send back the response, no errors, we can accept up to 4 parameters   
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as delimiter for the commands
+} // end of <Cmnd_Void>
 
-      }
-      //------------ CALIBRATE LOAD ---------------------------------------  @@@WORK_LOAD
-      else if (strcmp(sub1, CALIBRATE_RT_XT1 ) == 0) {   // detect RT        
- 
-        if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 1
+//================================================================
+// ABORT MEASUREMENTS  (abort command)
+//================================================================
+void Cmnd_Abort(const cmndEntry_t *cmnd)
+{
+  //--------- Abort 
+  SingleParamReadWrite_waitDone(CMD_ABORT, 0, 0, WRITE_MODE);    // abort
 
-          float floatVal = atof(sub2);  // this is the extracted value as float from argument1 
-          uint32_t val_rt = ConvFloatToInt32(floatVal);
-               
+  if (IsOK_Report_Err_Warn("Hardware error6", CMD_ABORT)) {
+  }   // check if no warnings and errors
+} // end of <Cmnd_Abort>
 
-          if (strcmp(sub3, CALIBRATE_XT_XT3 ) == 0) {  // here is the XT and we'll expect the argumen2 (xt value)
+//================================================================
+// MEASURE IMPEDANCE Z  (z command)
+//================================================================
+void Cmnd_MeasureZ(const cmndEntry_t *cmnd)
+{
+  MeasureZ_Start();
+} // end of <Cmnd_MeasureZ>
 
-            if (strcmp(sub4, VOID_STR) != 0) { // we have some data in argument 2
-              floatVal = atof(sub4);  // this is the extracted value as float from argument1 
-              uint32_t val_xt = ConvFloatToInt32(floatVal);
+//================================================================
+// Start Z run - <z> and every point of <sweep>
+//================================================================
+void MeasureZ_Start(void)
+{
+  ZDerived_Start();                       // the frequency for derived records - before the module gets busy
+  SingleParamReadWrite_waitDone(CMD_Z, 0, 0, WRITE_MODE, 1);    // start Z measurement, don't wait too long, just ones
+  // we're not waiting for DONE here!
+  measureZ_counter = 0;                   // counter for sequential measurements (if count > 1)
+  ZStats_Start();                         // statistics are per run
+  stateMeasureZ    = ACTIVE_Z;            // changing the state to active will trigger a chain of events to poll multiple times the Z result
+  Scheduler_StartRun();                   // first status poll when the first sample is expected
+} // end of <MeasureZ_Start>
 
-              SingleParamReadWrite_waitDone(CMD_CALIBRATE, ADDRESS_LOAD_CAL_SET_RT, val_rt, WRITE_MODE);  // set RT value for load calibration
+//================================================================
+// SWEEP command - <sweep start stop points [linear|log]> or <sweep list f1 f2 ...>, frequencies in kHz
+//================================================================
+void Cmnd_Sweep(const cmndEntry_t *cmnd)
+{
+  bool sweepStarted = false;
+
+  if (strcmp(sub1, SWEEP_LIST1) == 0) {   // explicit list - more values than sub0..sub4, they are the tokens from 2 on
+    float freqHz[SWEEP_LIST_MAX];
+    int numPoints = 0;
+    bool listOK = (numTokens - 2 <= SWEEP_LIST_MAX);
+    for (int ii = 2; listOK && (ii < numTokens); ii++) {
+      char *token = Command_Token(ii);
+      char *endPos;
+      double freqKHz = strtod(token, &endPos);
+      if ((endPos == token) || (*endPos != 0)) {
+        listOK = false;   // not a number - the whole list is refused, not run in part
+      }
+      else {
+        freqHz[numPoints++] = freqKHz * 1000;
+      }
+    }
+    if (!listOK) {
+      Bridge_SerialPrint("Error : sweep list takes up to ");
+      Out_UInt(SWEEP_LIST_MAX);
+      Bridge_SerialPrintLn(" frequencies in kHz");
+    }
+    else if (numPoints == 0) {
+      Bridge_SerialPrintLn("Error : sweep list needs frequencies");
+    }
+    else {
+      sweepStarted = Sweep_StartList(freqHz, numPoints);
+    }
+  }
+  else if ((strcmp(sub1, VOID_STR) != 0) && (strcmp(sub2, VOID_STR) != 0) && (strcmp(sub3, VOID_STR) != 0)) {   // start stop points
+    int scale = SWEEP_SCALE_LIN_VAL;
+    int numPoints = atoi(sub3);
+    if (strcmp(sub4, SWEEP_SCALE_LOG1) == 0) {
+      scale = SWEEP_SCALE_LOG_VAL;
+    }
+    else if ((strcmp(sub4, VOID_STR) != 0) && (strcmp(sub4, SWEEP_SCALE_LIN1) != 0)) {
+      Bridge_SerialPrintLn("Error : Wrong enum argument");
+      numPoints = 0;
+    }
+    else if (numPoints < SWEEP_MIN_POINTS) {
+      Bridge_SerialPrintLn("Error : sweep needs at least 2 points");
+    }
+    else if (numPoints > SWEEP_POINTS_MAX) {
+      Bridge_SerialPrint("Error : sweep takes up to ");
+      Out_UInt(SWEEP_POINTS_MAX);
+      Bridge_SerialPrintLn(" points");
+      numPoints = 0;
+    }
+    if (numPoints >= SWEEP_MIN_POINTS) {
+      sweepStarted = Sweep_StartRange(atof(sub1) * 1000, atof(sub2) * 1000, numPoints, scale);
+    }
+  }
+  else {
+    Bridge_SerialPrintLn("Error : sweep missing arguments");
+  }
 
-              if (IsOK_Report_Err_Warn("Call_LOAD coeff1 error", CMD_CALIBRATE)) {  // check argument 1
+  if (!sweepStarted) {   // errors are printed - the Z task would print the delimiter otherwise
+    Bridge_SerialPrintDelimiter();
+  }
+} // end of <Cmnd_Sweep>
 
-                SingleParamReadWrite_waitDone(CMD_CALIBRATE, ADDRESS_LOAD_CAL_SET_XT, val_xt, WRITE_MODE);  // set XT value for load calibration
-                if (IsOK_Report_Err_Warn("Call_LOAD coeff2 error", CMD_CALIBRATE)) {  // check argument 1
+//================================================================
+// <calibrate list> - every calibrated frequency with the number of gain sets
+//================================================================
+void PrintCalList_All(void)
+{
+  int numEntries = CalIndex_Count();
+  if (numEntries == 0) {
+    Bridge_SerialPrintLn("Warn : No calibrations found");
+    return;
+  }
 
-                  SingleParamReadWrite_waitDone(CMD_CALIBRATE, ADDRESS_LOAD_CAL, 0, WRITE_MODE, 1);  // LOAD calibration is initiated - DON'T WAIT too long (1)
+  for (int ii = 0; ii < numEntries; ii++) {
+    const calIndexEntry_t *entry = CalIndex_Entry(ii);
+    bool listed = false;
+    int numSets = 0;
+    for (int jj = 0; jj < numEntries; jj++) {  // count the sets of this frequency, print it at its first entry only
+      const calIndexEntry_t *other = CalIndex_Entry(jj);
+      if (fabs(other->freq - entry->freq) <= CAL_FREQ_TOLERANCE * fabs(entry->freq)) {
+        if (jj < ii) {
+          listed = true;
+          break;
+        }
+        numSets++;
+      }
+    }
+    if (listed) {
+      continue;
+    }
+    Bridge_SerialPrint("frequency = ");
+    Out_Float(entry->freq / 1000, 4);
+    Bridge_SerialPrint(" ");
+    Bridge_SerialPrint(FREQUENCY_POS_STR);
+    Bridge_SerialPrint(", sets = ");
+    Out_Int(numSets);
+    Bridge_SerialPrintLn();
+  }
+  if (CalIndex_Truncated()) {
+    Bridge_SerialPrintLn("Warn : Calibration index full - the list is truncated");
+  }
+} // end of PrintCalList_All()
 
-                  stateMeasureZ    = ACTIVE_CAL;    // changing the state to ACTIVE_CAL will trigger a chain of events to poll multiple times the CAL results
-                  flagCalError = false; // no error
-                  measureZ_counter = 0; // to display the result
+//================================================================
+// <calibrate list freq> - gain sets calibrated at this frequency (Hz)
+//================================================================
+void PrintCalList_Freq(float freq)
+{
+  const char calDone[] = "done";
+  const char calNotDone[] = "not_done";
+  bool found = false;
+
+  for (int ii = 0; ii < CalIndex_Count(); ii++) {
+    const calIndexEntry_t *entry = CalIndex_Entry(ii);
+    if (fabs(entry->freq - freq) > CAL_FREQ_TOLERANCE * fabs(freq)) {
+      continue;
+    }
+    found = true;
+    Bridge_SerialPrint("vgain = ");
+    Out_Int(entry->vgain);
+    Bridge_SerialPrint(", igain = ");
+    Out_Int(entry->igain);
+    Bridge_SerialPrint(", Short = ");
+    Bridge_SerialPrint((entry->status & MASK_SHORT_DONE) ? calDone : calNotDone);
+    Bridge_SerialPrint(", Open = ");
+    Bridge_SerialPrint((entry->status & MASK_OPEN_DONE) ? calDone : calNotDone);
+    Bridge_SerialPrint(", Load = ");
+    Bridge_SerialPrint((entry->status & MASK_LOAD_DONE) ? calDone : calNotDone);
+    Bridge_SerialPrint(", temp = ");
+    Out_Float(entry->temp, 4);
+    Bridge_SerialPrintLn();
+  }
+  if (!found) {
+    Bridge_SerialPrintLn("Warn : No calibrations found for this frequency");
+  }
+  if (CalIndex_Truncated()) {
+    Bridge_SerialPrintLn("Warn : Calibration index full - the list is truncated");
+  }
+} // end of PrintCalList_Freq()
 
-                } // was OK the argument2            
-              } // was OK the argument1    
-            }  // // we had existing argument2 
-          }  // we also had XT parameter
-        } // there was data in argument1
-      } // was detected LOAD >RT<
+//================================================================
+// CALIBRATE command tug (calibrate splits into multiple branches)
+//================================================================
+void Cmnd_Calibrate(const cmndEntry_t *cmnd)
+{
+  measureZ_counter = 0;                   // counter for sequential measurements - in all cases we need to reset it, let's do it here
+  bool flagCalError = true;               // error flag to report if something went wrong
 
-      //------------ CALIBRATE COMMIT ---------------------------------------
-      else if (strcmp(sub1, CALIBRATE_COMMIT1 ) == 0) {   // calibrate commit command       
+  // first task is to read the current Vgain and Igain as FREQ/GVAIN/IGAIN is the calibration "trinity" defining the CAL_INDEX
 
-        if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 1 (the password)
+  //------------ CALIBRATE SHORT ---------------------------------------
+  if (strcmp(sub1, CALIBRATE_SHORT1 ) == 0) {   // we start calibrate short
+    SingleParamReadWrite_waitDone(CMD_CALIBRATE, ADDRESS_SHORT_CAL, 0, WRITE_MODE);  // SHORT calibration is initiated
+    stateMeasureZ    = ACTIVE_CAL;    // changing the state to ACTIVE_CAL will trigger a chain of events to poll multiple times the CAL results
+    flagCalError = false; // no error
+    measureZ_counter = 0; // to display the result
 
-          if (strcmp(sub3, VOID_STR) != 0) { // we have some data in argument 2 (timestamp)       
-            resultA = atoi(sub3);  // this is timestamp
-          }
-          else {
-            resultA = 0x12345;   // no timestamp added - set it to some easy to recognize value
-          } // no timestamp - but let's tollerate it
+  }
+  //------------ CALIBRATE OPEN ---------------------------------------
+  else if (strcmp(sub1, CALIBRATE_OPEN1 ) == 0) {   // we start calibrate open
+    SingleParamReadWrite_waitDone(CMD_CALIBRATE, ADDRESS_OPEN_CAL, 0, WRITE_MODE);  // OPEN calibration is initiated
+    stateMeasureZ    = ACTIVE_CAL;    // changing the state to ACTIVE_CAL will trigger a chain of events to poll multiple times the CAL results
+    flagCalError = false; // no error
+    measureZ_counter = 0; // to display the result
 
-          for (int ii = 0; ii < ADDRESS_TIMESTAMP; ii++) {  // fill the password spaces
-            uint8_t nextChar = sub2[ii];     // get next char into nextChar var
+  }
+  //------------ CALIBRATE LOAD ---------------------------------------  @@@WORK_LOAD
+  else if (strcmp(sub1, CALIBRATE_RT_XT1 ) == 0) {   // detect RT        
 
-            if (nextChar == 0)  {            // this is the end of the password?
-              break;                         // abort the loop - this is the last char in the password
-            }
+    if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 1
 
-            SingleParamReadWrite_waitDone(CMD_CAL_COMMIT, ii, nextChar, WRITE_MODE, DEFAULT_MAX_NUMBER_WAIT);  // Fill the password locations, no reset SPI
-            IsOK_Report_Err_Warn("Commit calibration password", CMD_CAL_COMMIT);
-          } // fill all 12 locations with different password characters
+      float floatVal = atof(sub2);  // this is the extracted value as float from argument1 
+      uint32_t val_rt = ConvFloatToInt32(floatVal);
 
-          // there is a problem with TS functionality - it accepts only values <127 like it's password
-          // SingleParamReadWrite_waitDone(CMD_CAL_COMMIT, ADDRESS_TIMESTAMP, resultA, WRITE_MODE, DEFAULT_MAX_NUMBER_WAIT, true);  // set timestamp
-          // IsOK_Report_Err_Warn("Commit calibration TS", CMD_CAL_COMMIT);
 
-          SingleParamReadWrite_waitDone(CMD_CAL_COMMIT, ADDRESS_CAL_COMMIT, 0, WRITE_MODE, DEFAULT_MAX_NUMBER_WAIT);  // trigger the password comparision and data commit
+      if (strcmp(sub3, CALIBRATE_XT_XT3 ) == 0) {  // here is the XT and we'll expect the argumen2 (xt value)
 
-          stateMeasureZ    = ACTIVE_COMMIT_CAL;    // changing the state to ACTIVE_CAL will trigger a chain of events to poll multiple times the CAL results
-          flagCalError = false; // no error
+        if (strcmp(sub4, VOID_STR) != 0) { // we have some data in argument 2
+          floatVal = atof(sub4);  // this is the extracted value as float from argument1 
+          uint32_t val_xt = ConvFloatToInt32(floatVal);
 
-        } // we have the password
-        else
-        {
-          Bridge_SerialPrintLn("Error : Calibrate commit password missing!");
-          Bridge_SerialPrintDelimiter() ;  // end of the task
-        }          
-      }  // commit calibration  
+          SingleParamReadWrite_waitDone(CMD_CALIBRATE, ADDRESS_LOAD_CAL_SET_RT, val_rt, WRITE_MODE);  // set RT value for load calibration
 
-      //------------ CALIBRATE LIST ---------------------------------------
-      else if (strcmp(sub1, CALIBRATE_LIST1 ) == 0) {   // @@@CAL_LIST calibrate LIST command       
+          if (IsOK_Report_Err_Warn("Call_LOAD coeff1 error", CMD_CALIBRATE)) {  // check argument 1
 
-        if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 1 (frequency) and we need to get all calibrations for this frequency
+            SingleParamReadWrite_waitDone(CMD_CALIBRATE, ADDRESS_LOAD_CAL_SET_XT, val_xt, WRITE_MODE);  // set XT value for load calibration
+            if (IsOK_Report_Err_Warn("Call_LOAD coeff2 error", CMD_CALIBRATE)) {  // check argument 1
 
-          // SingleParamReadWrite_waitDone(CMD_CAL_COMMIT, ADDRESS_CAL_COMMIT, 0, WRITE_MODE, DEFAULT_MAX_NUMBER_WAIT);  // trigger the password comparision and data commit
+              SingleParamReadWrite_waitDone(CMD_CALIBRATE, ADDRESS_LOAD_CAL, 0, WRITE_MODE, 1);  // LOAD calibration is initiated - DON'T WAIT too long (1)
 
-          // stateMeasureZ    = ACTIVE_COMMIT_CAL;    // changing the state to ACTIVE_CAL will trigger a chain of events to poll multiple times the CAL results
+              stateMeasureZ    = ACTIVE_CAL;    // changing the state to ACTIVE_CAL will trigger a chain of events to poll multiple times the CAL results
+              flagCalError = false; // no error
+              measureZ_counter = 0; // to display the result
 
-        } // we have to list all calibrations for particular frequency
-        else
-        { // list all frequencies with calibrations
+            } // was OK the argument2            
+          } // was OK the argument1    
+        }  // // we had existing argument2 
+      }  // we also had XT parameter
+    } // there was data in argument1
+  } // was detected LOAD >RT<
 
-          // stateMeasureZ    = ACTIVE_COMMIT_CAL;    // changing the state to ACTIVE_CAL will trigger a chain of events to poll multiple times the CAL results
+  //------------ CALIBRATE COMMIT ---------------------------------------
+  else if (strcmp(sub1, CALIBRATE_COMMIT1 ) == 0) {   // calibrate commit command       
 
-        }  // was no freq parameter    
+    if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 1 (the password)
 
-          flagCalError = false; // no error
-          Bridge_SerialPrintLn("Error : Calibrate list command is under construction!");
-          Bridge_SerialPrintDelimiter() ;  // end of the task
+      // sub3 is the timestamp (optional) - it is not written, see below
 
-      }  // commit LIST  
+      for (int ii = 0; ii < ADDRESS_TIMESTAMP; ii++) {  // fill the password spaces
+        uint8_t nextChar = sub2[ii];     // get next char into nextChar var
 
+        if (nextChar == 0)  {            // this is the end of the password?
+          break;                         // abort the loop - this is the last char in the password
+        }
 
+        SingleParamReadWrite_waitDone(CMD_CAL_COMMIT, ii, nextChar, WRITE_MODE, DEFAULT_MAX_NUMBER_WAIT);  // Fill the password locations, no reset SPI
+        IsOK_Report_Err_Warn("Commit calibration password", CMD_CAL_COMMIT);
+      } // fill all 12 locations with different password characters
 
-      //------------ CALIBRATE ERASE ---------------------------------------
-      else if (strcmp(sub1, CALIBRATE_ERASE1 ) == 0) {   // calibrate erase command  @@@WORK     
+      // there is a problem with TS functionality - it accepts only values <127 like it's password
+      // SingleParamReadWrite_waitDone(CMD_CAL_COMMIT, ADDRESS_TIMESTAMP, (strcmp(sub3, VOID_STR) != 0) ? atoi(sub3) : 0x12345, WRITE_MODE, DEFAULT_MAX_NUMBER_WAIT, true);  // set timestamp
+      // IsOK_Report_Err_Warn("Commit calibration TS", CMD_CAL_COMMIT);
 
-        if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 1 (the password)
+      SingleParamReadWrite_waitDone(CMD_CAL_COMMIT, ADDRESS_CAL_COMMIT, 0, WRITE_MODE, DEFAULT_MAX_NUMBER_WAIT);  // trigger the password comparision and data commit
+      CalIndex_MarkStale();   // the stored sets may change - scan them again for <calibrate list>
 
-          for (int ii = 0; ii < ADDRESS_TIMESTAMP; ii++) {  // fill the password cells
-            uint8_t nextChar = sub2[ii];     // get next char into nextChar var
+      stateMeasureZ    = ACTIVE_COMMIT_CAL;    // changing the state to ACTIVE_CAL will trigger a chain of events to poll multiple times the CAL results
+      flagCalError = false; // no error
 
-            if (nextChar == 0)  {            // this is the end of the password?
-              break;                         // abort the loop - this is the last char in the password
-            }
+    } // we have the password
+    else
+    {
+      Bridge_SerialPrintLn("Error : Calibrate commit password missing!");
+      Bridge_SerialPrintDelimiter() ;  // end of the task
+    }          
+  }  // commit calibration  
+
+  //------------ CALIBRATE LIST ---------------------------------------
+  else if (strcmp(sub1, CALIBRATE_LIST1 ) == 0) {   // calibrate LIST - answered from the index, the gain sets are scanned only after commit/erase/reload
+
+    flagCalError = false; // no error
+    if (CalIndex_Refresh()) {
+      if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 1 (frequency in kHz) and we need to get all calibrations for this frequency
+        PrintCalList_Freq(atof(sub2) * 1000);
+      }
+      else
+      { // list all frequencies with calibrations
+        PrintCalList_All();
+      }  // was no freq parameter
+    }
+    else {
+      IsOK_Report_Err_Warn("Calibrate list", CMD_CAL_READ);
+    }
+    Bridge_SerialPrintDelimiter() ;  // end of the task
 
-            SingleParamReadWrite_waitDone(CMD_ERASE_CALIBRATION, ii, nextChar, WRITE_MODE, DEFAULT_MAX_NUMBER_WAIT);  // Fill the password locations, no reset SPI
-            IsOK_Report_Err_Warn("Calibrate erase password", CMD_ERASE_CALIBRATION);
-          } // fill up to 12 locations with different password characters
+  }  // calibrate LIST
 
-          SingleParamReadWrite_waitDone(CMD_ERASE_CALIBRATION, ADDRESS_CAL_ERASE, 0, WRITE_MODE, 1);  // trigger the password comparision and data commit, wait very short
 
-          stateMeasureZ    = ACTIVE_CALIBRATE_ERASE;    // changing the state to ACTIVE_CAL will trigger a chain of events to poll multiple times the CAL results
-          flagCalError = false; // no error
 
-        } // we have the password
-        else
-        {
-          Bridge_SerialPrintLn("Error : Calibrate erase password missing!");
-          Bridge_SerialPrintDelimiter() ;  // end of the task
-        }          
-      }  // calibrate erase  
+  //------------ CALIBRATE ERASE ---------------------------------------
+  else if (strcmp(sub1, CALIBRATE_ERASE1 ) == 0) {   // calibrate erase command  @@@WORK     
 
-      //------------ CALIBRATE ON or OFF ---------------------------------------
-      else if ((strcmp(sub1, CALIBRATE_ON1 ) == 0) ||  (strcmp(sub1, CALIBRATE_OFF1 ) == 0))  {   // detect calibrate ON or calibrate off        
-        int calSetupVal = 0;
-        if (strcmp(sub1, CALIBRATE_ON1 ) == 0) {
-          calSetupVal = 1;  // we enable the calibration
-        } // enable calibration
+    if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 1 (the password)
 
-        flagCalError = false; // no error
-        SingleParamReadWrite_waitDone(CMD_CORRECTION_MODE, 0, calSetupVal, WRITE_MODE);  // set the calibration on/off
+      for (int ii = 0; ii < ADDRESS_TIMESTAMP; ii++) {  // fill the password cells
+        uint8_t nextChar = sub2[ii];     // get next char into nextChar var
 
-        if (calSetupVal) {  // output the string
-          Bridge_SerialPrintLn("Calibration is enabled");
-        } 
-        else {
-          Bridge_SerialPrintLn("Calibration is disabled");
-        } 
+        if (nextChar == 0)  {            // this is the end of the password?
+          break;                         // abort the loop - this is the last char in the password
+        }
 
-        Bridge_SerialPrintDelimiter() ;  // end of the task
-      }   // detected calibrate on / off
+        SingleParamReadWrite_waitDone(CMD_ERASE_CALIBRATION, ii, nextChar, WRITE_MODE, DEFAULT_MAX_NUMBER_WAIT);  // Fill the password locations, no reset SPI
+        IsOK_Report_Err_Warn("Calibrate erase password", CMD_ERASE_CALIBRATION);
+      } // fill up to 12 locations with different password characters
 
-      //------------ CALIBRATE RELOAD ---------------------------------------
-      else if (strcmp(sub1, CALIBRATE_RELOAD1 ) == 0)  {   // detect calibrate reload        
-        
-        flagCalError = false; // suppress the error message
-        SingleParamReadWrite_waitDone(CMD_CALIBRATE, ADDRESS_RELOAD_CAL, 0, WRITE_MODE,1);  // calibrate reload - we don't wait as it may take longer
+      SingleParamReadWrite_waitDone(CMD_ERASE_CALIBRATION, ADDRESS_CAL_ERASE, 0, WRITE_MODE, 1);  // trigger the password comparision and data commit, wait very short
+                              // the calibration index is cleared when the erase is done (a wrong password keeps everything)
 
-        stateMeasureZ = ACTIVE_RELOAD_CAL;   // @@@CALIBR go into long wait mode for calibrate reload
+      stateMeasureZ    = ACTIVE_CALIBRATE_ERASE;    // changing the state to ACTIVE_CAL will trigger a chain of events to poll multiple times the CAL results
+      flagCalError = false; // no error
 
+    } // we have the password
+    else
+    {
+      Bridge_SerialPrintLn("Error : Calibrate erase password missing!");
+      Bridge_SerialPrintDelimiter() ;  // end of the task
+    }          
+  }  // calibrate erase  
+
+  //------------ CALIBRATE ON or OFF ---------------------------------------
+  else if ((strcmp(sub1, CALIBRATE_ON1 ) == 0) ||  (strcmp(sub1, CALIBRATE_OFF1 ) == 0))  {   // detect calibrate ON or calibrate off        
+    int calSetupVal = 0;
+    if (strcmp(sub1, CALIBRATE_ON1 ) == 0) {
+      calSetupVal = 1;  // we enable the calibration
+    } // enable calibration
+
+    flagCalError = false; // no error
+    SingleParamReadWrite_waitDone(CMD_CORRECTION_MODE, 0, calSetupVal, WRITE_MODE);  // set the calibration on/off
+    Shadow_NoteWrite(CMD_CORRECTION_MODE, calSetupVal);
+
+    if (calSetupVal) {  // output the string
+      Bridge_SerialPrintLn("Calibration is enabled");
+    } 
+    else {
+      Bridge_SerialPrintLn("Calibration is disabled");
+    } 
 
-      } // end of Calibrate reload
+    Bridge_SerialPrintDelimiter() ;  // end of the task
+  }   // detected calibrate on / off
 
-      //------------ NOT RECOGNIZED CAL IDENTIFIER ------------------------------
-      else {  // not recognized identifier
-        Bridge_SerialPrintLn("Error : Non supported cal parameter!");  // report the integer response
-        Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+  //------------ CALIBRATE RELOAD ---------------------------------------
+  else if (strcmp(sub1, CALIBRATE_RELOAD1 ) == 0)  {   // detect calibrate reload        
 
-      }
+    flagCalError = false; // suppress the error message
+    SingleParamReadWrite_waitDone(CMD_CALIBRATE, ADDRESS_RELOAD_CAL, 0, WRITE_MODE,1);  // calibrate reload - we don't wait as it may take longer
+    Shadow_InvalidateAll();   // calibration data for a new trinity - read the parameters again
+    CalIndex_MarkStale();     // the sets of the new frequency are added at the next <calibrate list>
 
-      if (flagCalError) { // something went wrong - show CAL ERROR message
-        Bridge_SerialPrintLn("Error : Cal parameters mismatched!");  // report the integer response
-      } // something was not OK 
+    stateMeasureZ = ACTIVE_RELOAD_CAL;   // @@@CALIBR go into long wait mode for calibrate reload
 
-    } // was CALIBRATE task (a tug with multiple commands)
 
-  //===================================================================
-  // RDCAL command - read calibration coefficients 
-  //===================================================================
-    else if(strcmp(sub0, READCAL0) == 0)  // rdcal detected?  @@@WORK2
-    { 
-      bool flagNoArg = true;
-      int vgain = 0; 
-      int igain = 0;
-      if (strcmp(sub1, VOID_STR) != 0) { // we have some data in argument 1
-        vgain = atoi(sub1);  // this is the extracted value as integer from the argument1 (VGAIN)
-
-        if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 2
-          igain = atoi(sub2);  // this is the extracted value as integer from the argument2 (IGAIN)
-          flagNoArg = false;     // no error report
-                    
-          // make test write for Ro to see if there is an error - if we get error - it's because there is nothing stored there and we need to show defaults
-          SingleParamReadWrite_waitDone(CMD_CAL_READ, MASK_LSB_COEFFICIENT | ((igain & 0x03) << 2) | (vgain & 0x03), 0, READ_MODE);  // Request reading Ro coeff LSB
-          
-          if (flag_ERROR == false) {  // we have valid coeff in memory - it's easy to tell from Ro - if pure zero, we need to show defaults 
-//--------- OUTPUT all 12 calibration coefficients
-            ReadCalibrationDouble(CALL_ADDR_Ro, vgain, igain, "Ro = ");   // get Ro
-            ReadCalibrationDouble(CALL_ADDR_Xo, vgain, igain, "Xo = ");   // get Xo
-            ReadCalibrationDouble(CALL_ADDR_Go, vgain, igain, "Go = ");   // get Go
-            ReadCalibrationDouble(CALL_ADDR_Bo, vgain, igain, "Bo = ");   // get Bo
-
-            ReadCalibrationDouble(CALL_ADDR_Rs, vgain, igain, "Rs = ");   // get Rs
-            ReadCalibrationDouble(CALL_ADDR_Xs, vgain, igain, "Xs = ");   // get Xs
-            ReadCalibrationDouble(CALL_ADDR_Gs, vgain, igain, "Gs = ");   // get Gs
-            ReadCalibrationDouble(CALL_ADDR_Bs, vgain, igain, "Bs = ");   // get Bs
-
-            ReadCalibrationDouble(CALL_ADDR_Rg, vgain, igain, "Rg = ");   // get Rg
-            ReadCalibrationDouble(CALL_ADDR_Xg, vgain, igain, "Xg = ");   // get Xg
-            ReadCalibrationDouble(CALL_ADDR_Gg, vgain, igain, "Gg = ");   // get Gg
-            ReadCalibrationDouble(CALL_ADDR_Bg, vgain, igain, "Bg = ");   // get Bg
-
-          } // there was no error for this set of Vgain and Igain
-          else
-          { // both int32 for Ro were zero - we need to show defaults!
-            Bridge_SerialPrintLn("Warn : No cal coefficients found for V_gain and I_gain. Defaults values:");
-            Bridge_SerialPrintLn("Ro = 1.0e+06"); 
-            Bridge_SerialPrintLn("Xo = 1.0e+06"); 
-            Bridge_SerialPrintLn("Go = 0.0e+00"); 
-            Bridge_SerialPrintLn("Bo = 0.0e+00"); 
-
-            Bridge_SerialPrintLn("Rs = 0.0e+00"); 
-            Bridge_SerialPrintLn("Xs = 0.0e+00"); 
-            Bridge_SerialPrintLn("Gs = 1.0e+06"); 
-            Bridge_SerialPrintLn("Bs = 1.0e+06"); 
-
-            Bridge_SerialPrintLn("Rg = -1.0e+06"); 
-            Bridge_SerialPrintLn("Xg = -1.0e+06"); 
-            Bridge_SerialPrintLn("Gg = -1.0e+06"); 
-            Bridge_SerialPrintLn("Bg = -1.0e+06"); 
-          } // was error - no data for these Vgain/Igain - show default coefficients!
-
-          // output calibration status - which CAL were done
-          resultA = SingleParamReadWrite_waitDone(CMD_CAL_READ, (CALL_ADDR_AC_STATUS << SHIFT_ADDR_READ_CAL) | \
-                                                        ((igain & 0x03) << 2) | (vgain & 0x03), 0, READ_MODE);  // Request reading Ro coeff LSB
-
-          const char calDone[] = "done";
-          const char calNotDone[] = "not_done";
-
-          Bridge_SerialPrint("Short = ");
-          if (resultA & MASK_SHORT_DONE) { Bridge_SerialPrint(calDone); }
-            else {Bridge_SerialPrint(calNotDone);}         
-          
-          Bridge_SerialPrint(", Open = ");
-          if (resultA & MASK_OPEN_DONE) { Bridge_SerialPrint(calDone); }
-            else {Bridge_SerialPrint(calNotDone);} 
-
-          Bridge_SerialPrint(", Load = ");
-          if (resultA & MASK_LOAD_DONE) { Bridge_SerialPrintLn(calDone); }
-            else {Bridge_SerialPrintLn(calNotDone);} 
-
-        } // second argument was not void string
-      } // we have first argumanet (VGAIN)
-
-      if (flagNoArg)  { // missing arguments
-        Bridge_SerialPrintLn("Error : rdcal missing arguments!");  // report the for missing arguments
-      }
+  } // end of Calibrate reload
 
-      Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+  //------------ NOT RECOGNIZED CAL IDENTIFIER ------------------------------
+  else {  // not recognized identifier
+    Bridge_SerialPrintLn("Error : Non supported cal parameter!");  // report the integer response
+    Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
 
-    } // was RDCAL command
-  //===================================================================
-  // RESETCAL command - resets all or some calibration coefficients
-  //===================================================================
-    else if(strcmp(sub0, RESETCAL0) == 0)  // resetcal detected?
-    { 
-      bool flagResetCalErr = true;
-      int mask_RESETCAL = 0;
-      if (strcmp(sub1, VOID_STR) != 0) { // we have some data in argument 1
-        resultA = atoi(sub1) & 0x03;  // this is V gain
-
-        if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 2
-          resultB = atoi(sub2) & 0x03;  // this is I gain
-          mask_RESETCAL = resultA | (resultB << 2); 
-          flagResetCalErr = false;
-          SingleParamReadWrite_waitDone(CMD_RESET_CAL, mask_RESETCAL, 0, WRITE_MODE);  // Request reading Ro coeff LSB
-          Bridge_SerialPrintLn("Reset : success");
-        } // we have two arguments, and we need to set the mask
-      }  // argument 1 is non void
+  }
+
+  if (flagCalError) { // something went wrong - show CAL ERROR message
+    Bridge_SerialPrintLn("Error : Cal parameters mismatched!");  // report the integer response
+  } // something was not OK 
+} // end of <Cmnd_Calibrate>
+
+//================================================================
+// RDCAL command - read calibration coefficients
+//================================================================
+void Cmnd_ReadCal(const cmndEntry_t *cmnd)
+{
+  uint32_t resultA;      // temp data
+  bool flagNoArg = true;
+  int vgain = 0; 
+  int igain = 0;
+  if (strcmp(sub1, VOID_STR) != 0) { // we have some data in argument 1
+    vgain = atoi(sub1);  // this is the extracted value as integer from the argument1 (VGAIN)
+
+    if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 2
+      igain = atoi(sub2);  // this is the extracted value as integer from the argument2 (IGAIN)
+      flagNoArg = false;     // no error report
+
+      // make test write for Ro to see if there is an error - if we get error - it's because there is nothing stored there and we need to show defaults
+      SingleParamReadWrite_waitDone(CMD_CAL_READ, MASK_LSB_COEFFICIENT | ((igain & 0x03) << 2) | (vgain & 0x03), 0, READ_MODE);  // Request reading Ro coeff LSB
+
+      if (flag_ERROR == false) {  // we have valid coeff in memory - it's easy to tell from Ro - if pure zero, we need to show defaults 
+  //--------- OUTPUT all 12 calibration coefficients
+        ReadCalibrationDouble(CALL_ADDR_Ro, vgain, igain, "Ro = ");   // get Ro
+        ReadCalibrationDouble(CALL_ADDR_Xo, vgain, igain, "Xo = ");   // get Xo
+        ReadCalibrationDouble(CALL_ADDR_Go, vgain, igain, "Go = ");   // get Go
+        ReadCalibrationDouble(CALL_ADDR_Bo, vgain, igain, "Bo = ");   // get Bo
+
+        ReadCalibrationDouble(CALL_ADDR_Rs, vgain, igain, "Rs = ");   // get Rs
+        ReadCalibrationDouble(CALL_ADDR_Xs, vgain, igain, "Xs = ");   // get Xs
+        ReadCalibrationDouble(CALL_ADDR_Gs, vgain, igain, "Gs = ");   // get Gs
+        ReadCalibrationDouble(CALL_ADDR_Bs, vgain, igain, "Bs = ");   // get Bs
+
+        ReadCalibrationDouble(CALL_ADDR_Rg, vgain, igain, "Rg = ");   // get Rg
+        ReadCalibrationDouble(CALL_ADDR_Xg, vgain, igain, "Xg = ");   // get Xg
+        ReadCalibrationDouble(CALL_ADDR_Gg, vgain, igain, "Gg = ");   // get Gg
+        ReadCalibrationDouble(CALL_ADDR_Bg, vgain, igain, "Bg = ");   // get Bg
+
+      } // there was no error for this set of Vgain and Igain
       else
-      {
-        flagResetCalErr = false; // there is no error, just no arguments - set mask=FF
-          SingleParamReadWrite_waitDone(CMD_RESET_CAL, MASK_RESET_ALL_CAL, 0, WRITE_MODE);  // Request reading Ro coeff LSB
-          Bridge_SerialPrintLn("Resetting all : success");
-      } // no arguents - erase all
+      { // both int32 for Ro were zero - we need to show defaults!
+        Bridge_SerialPrintLn("Warn : No cal coefficients found for V_gain and I_gain. Defaults values:");
+        Bridge_SerialPrintLn("Ro = 1.0e+06"); 
+        Bridge_SerialPrintLn("Xo = 1.0e+06"); 
+        Bridge_SerialPrintLn("Go = 0.0e+00"); 
+        Bridge_SerialPrintLn("Bo = 0.0e+00"); 
+
+        Bridge_SerialPrintLn("Rs = 0.0e+00"); 
+        Bridge_SerialPrintLn("Xs = 0.0e+00"); 
+        Bridge_SerialPrintLn("Gs = 1.0e+06"); 
+        Bridge_SerialPrintLn("Bs = 1.0e+06"); 
+
+        Bridge_SerialPrintLn("Rg = -1.0e+06"); 
+        Bridge_SerialPrintLn("Xg = -1.0e+06"); 
+        Bridge_SerialPrintLn("Gg = -1.0e+06"); 
+        Bridge_SerialPrintLn("Bg = -1.0e+06"); 
+      } // was error - no data for these Vgain/Igain - show default coefficients!
+
+      // output calibration status - which CAL were done
+      resultA = SingleParamReadWrite_waitDone(CMD_CAL_READ, (CALL_ADDR_AC_STATUS << SHIFT_ADDR_READ_CAL) | \
+                                                    ((igain & 0x03) << 2) | (vgain & 0x03), 0, READ_MODE);  // Request reading Ro coeff LSB
+
+      const char calDone[] = "done";
+      const char calNotDone[] = "not_done";
+
+      Bridge_SerialPrint("Short = ");
+      if (resultA & MASK_SHORT_DONE) { Bridge_SerialPrint(calDone); }
+        else {Bridge_SerialPrint(calNotDone);}         
+
+      Bridge_SerialPrint(", Open = ");
+      if (resultA & MASK_OPEN_DONE) { Bridge_SerialPrint(calDone); }
+        else {Bridge_SerialPrint(calNotDone);} 
+
+      Bridge_SerialPrint(", Load = ");
+      if (resultA & MASK_LOAD_DONE) { Bridge_SerialPrintLn(calDone); }
+        else {Bridge_SerialPrintLn(calNotDone);} 
+
+    } // second argument was not void string
+  } // we have first argumanet (VGAIN)
+
+  if (flagNoArg)  { // missing arguments
+    Bridge_SerialPrintLn("Error : rdcal missing arguments!");  // report the for missing arguments
+  }
 
-      if (flagResetCalErr)  { // no error - complete operation
-        Bridge_SerialPrintLn("Error : resetcal missing arguments!");  // report the for missing arguments
-      } // was error 
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_ReadCal>
 
-      Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+//================================================================
+// One calibration set as text line <vgain,igain,0xstatus,freq,temp,Ro,Xo...Bg>, no coefficients - <vgain,igain,0xstatus>
+//================================================================
+void PrintCalBlock(int vgain, int igain, const calBlock_t *block)
+{
+  char floatBuffer[SCI7_BUF_LEN];   // here we store the float shar
+  uint32_t wordBits;
+
+  Out_Int(vgain);
+  Out_Char(',');
+  Out_Int(igain);
+  Bridge_SerialPrint(",0x");
+  Out_Hex(block->status);
+  if (block->hasCoeffs) {
+    wordBits = block->freqBits;
+    FormatSci7(ConvInt32ToFloat(wordBits), floatBuffer);
+    Out_Char(',');
+    Bridge_SerialPrint(floatBuffer);
+    wordBits = block->tempBits;
+    FormatSci7(ConvInt32ToFloat(wordBits), floatBuffer);
+    Out_Char(',');
+    Bridge_SerialPrint(floatBuffer);
+    for (int ii = 0; ii < CAL_NUM_COEFFS; ii++) {
+      uint64_t coeffBits = ((uint64_t)block->coeff[2 * ii + 1] << 32) | block->coeff[2 * ii];
+      FormatSci7(ConvInt64ToDouble(coeffBits), floatBuffer);
+      Out_Char(',');
+      Bridge_SerialPrint(floatBuffer);
+    }
+  }
+  Bridge_SerialPrintLn();
+} // end of PrintCalBlock()
 
-    } // was resetcal command
+//================================================================
+// One calibration set as binary record BIN_TYPE_CAL
+//================================================================
+void WriteCalBlock(int vgain, int igain, const calBlock_t *block)
+{
+  byte payload[BIN_CAL_PAYLOAD_LEN];
+
+  payload[0] = (byte)vgain;
+  payload[1] = (byte)igain;
+  memcpy(&payload[2], &block->status, 4);
+  if (!block->hasCoeffs) {
+    Bridge_SerialWriteRecord(BIN_TYPE_CAL, payload, BIN_CAL_EMPTY_LEN);
+    return;
+  }
+  memcpy(&payload[6],  &block->freqBits, 4);
+  memcpy(&payload[10], &block->tempBits, 4);
+  memcpy(&payload[14], block->coeff, sizeof(block->coeff));
+  Bridge_SerialWriteRecord(BIN_TYPE_CAL, payload, BIN_CAL_PAYLOAD_LEN);
+} // end of WriteCalBlock()
 
-  //===================================================================
-  // STORECAL command - stores individual coefficients into RAM for vgain/igain/freq trinity @@@WORK3
-  //===================================================================
-    else if(strcmp(sub0, STORECAL0) == 0)  // STORECAL detected?
-    { 
-      bool flagWrongArguments = true;  // if true - we'll not proceed sending commands
-      int v_gain, i_gain;
-      double dfloatValue;
-      uint64_t valToWrite;
-
-      if (strcmp(sub1, VOID_STR) != 0) { // we have some data in argument 1
-        v_gain = atoi(sub1) & 0x03;  // this is V gain
-
-        if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 2
-          i_gain = atoi(sub2) & 0x03;  // this is I gain
-        
-          if (strcmp(sub3, VOID_STR) != 0) { // we have some data in argument 3
-            int tokenVal = -1;   // negative value - no tocken
-            for (int ii = 0; ii < 12; ii++) {   // scan for tockens
-               
-              if (strcmp(sub3, STORE_CAL_FIELDS1[ii]) == 0) { // we have tocken match
-                tokenVal = ii;
-                break; // break the loop
-              } // token match - abort and get the index
-            }  // compare with 12 tokens
-
-            if ((tokenVal >= 0) && (strcmp(sub4, VOID_STR) != 0)) { // we have some data in argument 4 - this is the coefficient double floating value
-              flagWrongArguments = false;  // suppress error message
-
-              dfloatValue = atof(sub4);  // convert to double  
-              valToWrite = ConvDoubleToInt64(dfloatValue);
-
-              SingleParamReadWrite_waitDone(CMD_STORE_CAL, (tokenVal << SHIFT_ADDR_STORE_CAL) | MASK_LSB_COEFFICIENT | (i_gain << 2) | v_gain, \
-                                            (uint32_t)(valToWrite & 0xFFFFFFFF), WRITE_MODE, DEFAULT_MAX_NUMBER_WAIT);  // Fill the password locations, no reset SPI
-              IsOK_Report_Err_Warn("StoreCal failure LSB", CMD_STORE_CAL);
- 
-              SingleParamReadWrite_waitDone(CMD_STORE_CAL, (tokenVal << SHIFT_ADDR_STORE_CAL) | MASK_MSB_COEFFICIENT | (i_gain << 2) | v_gain, \
-                                            (uint32_t)(valToWrite >> 32), WRITE_MODE, DEFAULT_MAX_NUMBER_WAIT);  // Fill the password locations, no reset SPI
-              IsOK_Report_Err_Warn("StoreCal failure MSB", CMD_STORE_CAL);
-              
-            } // we have the coefficient value and found the token - ready to proceed
-          } // name of parameter exists
-        } // igain was existing
-      } // vgain was existing
-
-      if (flagWrongArguments) { // we have to repot an error
-        Bridge_SerialPrintLn("Error : StoreCal invalid parameters");
-      }  
-      
-      Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+//================================================================
+// RDCALALL command - all calibration sets (or one) in one block
+// <rdcalall>, <rdcalall bin>, <rdcalall vgain igain>, <rdcalall vgain igain bin>
+//================================================================
+void Cmnd_ReadCalAll(const cmndEntry_t *cmnd)
+{
+  calBlock_t block;           // raw words of one vgain/igain set
+  int gainFirst = 0;          // gain index = vgain + 4 * igain
+  int gainLast  = CAL_NUM_GAINS * CAL_NUM_GAINS - 1;
+  bool binaryOut = false;
+  const char *optStr = sub1;  // optional <bin>
+
+  if ((strcmp(sub1, VOID_STR) != 0) && (strcmp(sub1, READCALALL_BIN1) != 0)) {   // vgain igain
+    if (strcmp(sub2, VOID_STR) == 0) {
+      Bridge_SerialPrintLn("Error : rdcalall needs both vgain and igain");
+      Bridge_SerialPrintDelimiter();
+      return;
+    }
+    gainFirst = (atoi(sub1) & 0x03) + CAL_NUM_GAINS * (atoi(sub2) & 0x03);
+    gainLast  = gainFirst;
+    optStr = sub3;
+  }
+  if (strcmp(optStr, READCALALL_BIN1) == 0) {
+    binaryOut = true;
+  }
+  else if (strcmp(optStr, VOID_STR) != 0) {
+    Bridge_SerialPrintLn("Error : Wrong enum argument");
+    Bridge_SerialPrintDelimiter();
+    return;
+  }
+
+  if (!binaryOut) {   // column names
+    Bridge_SerialPrint("vgain,igain,status,freq,temp");
+    for (int ii = 0; ii < CAL_NUM_COEFFS; ii++) {
+      Out_Char(',');
+      Bridge_SerialPrint(STORE_CAL_FIELDS1[ii]);
+    }
+    Bridge_SerialPrintLn();
+  }
 
-    } // was storcal command
+  for (int gainIdx = gainFirst; gainIdx <= gainLast; gainIdx++) {
+    int vgain = gainIdx % CAL_NUM_GAINS;
+    int igain = gainIdx / CAL_NUM_GAINS;
+    if (!ReadCalibrationBlock(vgain, igain, &block)) {
+      IsOK_Report_Err_Warn("rdcalall", CMD_CAL_READ);   // report why and stop - the next sets would fail the same way
+      break;
+    }
+    if (binaryOut) {
+      WriteCalBlock(vgain, igain, &block);
+    }
+    else {
+      PrintCalBlock(vgain, igain, &block);
+    }
+  }
 
-  //===================================================================
-  // SET VGAIN and IGAIN COMMANDs
-  //===================================================================
-    else if(strcmp(sub0, SETGAIN0) == 0) {  //this is setgain command
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_ReadCalAll>
+
+//================================================================
+// RESETCAL command - resets all or some calibration coefficients
+//================================================================
+void Cmnd_ResetCal(const cmndEntry_t *cmnd)
+{
+  uint32_t resultA, resultB;   // temp data
+  bool flagResetCalErr = true;
+  int mask_RESETCAL = 0;
+  if (strcmp(sub1, VOID_STR) != 0) { // we have some data in argument 1
+    resultA = atoi(sub1) & 0x03;  // this is V gain
+
+    if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 2
+      resultB = atoi(sub2) & 0x03;  // this is I gain
+      mask_RESETCAL = resultA | (resultB << 2); 
+      flagResetCalErr = false;
+      SingleParamReadWrite_waitDone(CMD_RESET_CAL, mask_RESETCAL, 0, WRITE_MODE);  // Request reading Ro coeff LSB
+      Bridge_SerialPrintLn("Reset : success");
+    } // we have two arguments, and we need to set the mask
+  }  // argument 1 is non void
+  else
+  {
+    flagResetCalErr = false; // there is no error, just no arguments - set mask=FF
+      SingleParamReadWrite_waitDone(CMD_RESET_CAL, MASK_RESET_ALL_CAL, 0, WRITE_MODE);  // Request reading Ro coeff LSB
+      Bridge_SerialPrintLn("Resetting all : success");
+  } // no arguents - erase all
+
+  if (flagResetCalErr)  { // no error - complete operation
+    Bridge_SerialPrintLn("Error : resetcal missing arguments!");  // report the for missing arguments
+  } // was error 
+
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_ResetCal>
+
+//================================================================
+// STORECAL command - stores individual coefficients into RAM for vgain/igain/freq trinity @@@WORK3
+//================================================================
+void Cmnd_StoreCal(const cmndEntry_t *cmnd)
+{
+  bool flagWrongArguments = true;  // if true - we'll not proceed sending commands
+  int v_gain, i_gain;
+  double dfloatValue;
+  uint64_t valToWrite;
+
+  if (strcmp(sub1, VOID_STR) != 0) { // we have some data in argument 1
+    v_gain = atoi(sub1) & 0x03;  // this is V gain
+
+    if (strcmp(sub2, VOID_STR) != 0) { // we have some data in argument 2
+      i_gain = atoi(sub2) & 0x03;  // this is I gain
+
+      if (strcmp(sub3, VOID_STR) != 0) { // we have some data in argument 3
+        int tokenVal = CalTokenIndex(sub3);   // negative value - no tocken
+
+        if ((tokenVal >= 0) && (strcmp(sub4, VOID_STR) != 0)) { // we have some data in argument 4 - this is the coefficient double floating value
+          flagWrongArguments = false;  // suppress error message
+
+          dfloatValue = atof(sub4);  // convert to double  
+          valToWrite = ConvDoubleToInt64(dfloatValue);
+
+          SingleParamReadWrite_waitDone(CMD_STORE_CAL, (tokenVal << SHIFT_ADDR_STORE_CAL) | MASK_LSB_COEFFICIENT | (i_gain << 2) | v_gain, \
+                                        (uint32_t)(valToWrite & 0xFFFFFFFF), WRITE_MODE, DEFAULT_MAX_NUMBER_WAIT);  // Fill the password locations, no reset SPI
+          IsOK_Report_Err_Warn("StoreCal failure LSB", CMD_STORE_CAL);
 
-      bool flag_V_I_gain = false;
-      char reportStr[20];  // keep response here
+          SingleParamReadWrite_waitDone(CMD_STORE_CAL, (tokenVal << SHIFT_ADDR_STORE_CAL) | MASK_MSB_COEFFICIENT | (i_gain << 2) | v_gain, \
+                                        (uint32_t)(valToWrite >> 32), WRITE_MODE, DEFAULT_MAX_NUMBER_WAIT);  // Fill the password locations, no reset SPI
+          IsOK_Report_Err_Warn("StoreCal failure MSB", CMD_STORE_CAL);
+
+        } // we have the coefficient value and found the token - ready to proceed
+      } // name of parameter exists
+    } // igain was existing
+  } // vgain was existing
+
+  if (flagWrongArguments) { // we have to repot an error
+    Bridge_SerialPrintLn("Error : StoreCal invalid parameters");
+  }  
+
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_StoreCal>
+
+//================================================================
+// SET VGAIN and IGAIN COMMANDs
+//================================================================
+void Cmnd_SetGain(const cmndEntry_t *cmnd)
+{
+  uint32_t resultA, resultB, resultC;   // temp data
+  byte grCommand;        // the command we send to SPI
+  bool flag_V_I_gain = false;
+  char reportStr[20];  // keep response here
 
   //---------- AUTO GAIN ----------------------    
-      if(strcmp(sub1, SETGAIN_AUTO1) == 0) { // check if second argument is auto ?
-        SingleParamReadWrite_waitDone(CMD_ENABLE_AUTORANGE, 0, 1, WRITE_MODE);  // enable autorange 
+  if(strcmp(sub1, SETGAIN_AUTO1) == 0) { // check if second argument is auto ?
+    SingleParamReadWrite_waitDone(CMD_ENABLE_AUTORANGE, 0, 1, WRITE_MODE);  // enable autorange 
+    Shadow_NoteWrite(CMD_ENABLE_AUTORANGE, 1);  // from now the module sets the gains - they are not kept
 
-        if (IsOK_Report_Err_Warn("Wrong arguments", CMD_ENABLE_AUTORANGE))   // check if no warnings and errors
-        {
-        Bridge_SerialPrintLn("Autorange enabled");  // report autorange was enabled
-        Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
-        } // everthing was OK
+    if (IsOK_Report_Err_Warn("Wrong arguments", CMD_ENABLE_AUTORANGE))   // check if no warnings and errors
+    {
+    Bridge_SerialPrintLn("Autorange enabled");  // report autorange was enabled
+    Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+    } // everthing was OK
 
-      } // was auto gen
+  } // was auto gen
 
   //---------- WRITE VOLTAGE GAIN (stageA) ----------------------    
-      else if ((strcmp(sub1, SETGAIN_VGAIN1) == 0) && \
-              (strcmp(sub2, VOID_STR) != 0)) {  // setup VGAIN values - extract from sub2 (which is not void)
-        grCommand = CMD_VOLTAGE_GAIN;
-        strcpy(reportStr, SETGAIN_RESP_V1);
-        flag_V_I_gain = true;    // Vgain is needed      
-      } // was vgain
+  else if ((strcmp(sub1, SETGAIN_VGAIN1) == 0) && \
+          (strcmp(sub2, VOID_STR) != 0)) {  // setup VGAIN values - extract from sub2 (which is not void)
+    grCommand = CMD_VOLTAGE_GAIN;
+    strcpy(reportStr, SETGAIN_RESP_V1);
+    flag_V_I_gain = true;    // Vgain is needed      
+  } // was vgain
 
   //---------- WRITE VOLTAGE GAIN (stageA)----------------------    
-      else if ((strcmp(sub1, SETGAIN_IGAIN1) == 0) && \
-              (strcmp(sub2, VOID_STR) != 0)) {  // setup VGAIN values - extract from sub2 (which is not void)
-        grCommand = CMD_CURRENT_GAIN;
-        strcpy(reportStr, SETGAIN_RESP_I1);
-        flag_V_I_gain = true;    // Igain is needed      
-      } // was igain
+  else if ((strcmp(sub1, SETGAIN_IGAIN1) == 0) && \
+          (strcmp(sub2, VOID_STR) != 0)) {  // setup VGAIN values - extract from sub2 (which is not void)
+    grCommand = CMD_CURRENT_GAIN;
+    strcpy(reportStr, SETGAIN_RESP_I1);
+    flag_V_I_gain = true;    // Igain is needed      
+  } // was igain
 
   //---------- READ GAIN SETTINGS ----------------------    
-      else if(strcmp(sub1, VOID_STR) == 0) // read gain command
-      {      
+  else if(strcmp(sub1, VOID_STR) == 0) // read gain command
+  {      
   //--------- READ SETGAIN setttings
-        resultA = SingleParamReadWrite_waitDone(CMD_VOLTAGE_GAIN     | CMND_READ_MASK, 0, 0, READ_MODE);
-        resultB = SingleParamReadWrite_waitDone(CMD_CURRENT_GAIN     | CMND_READ_MASK, 0, 0, READ_MODE);
-        resultC = SingleParamReadWrite_waitDone(CMD_ENABLE_AUTORANGE | CMND_READ_MASK, 0, 0, READ_MODE);
+    Shadow_ReadParam(CMD_ENABLE_AUTORANGE, &resultC, forceHwRead, NULL);  // autorange first - it tells if the gains can be kept
+    Shadow_ReadParam(CMD_VOLTAGE_GAIN,     &resultA, forceHwRead, NULL);
+    Shadow_ReadParam(CMD_CURRENT_GAIN,     &resultB, forceHwRead, NULL);
 
-        if (resultC & 0x01) { // AUTORANGE DETECTED
-          Bridge_SerialPrintLn("Autorange enabled"); } // report autorange was enabled
-        else {
-           Bridge_SerialPrintLn("Autorange disabled"); } // report autorange was disabled
+    if (resultC & 0x01) { // AUTORANGE DETECTED
+      Bridge_SerialPrintLn("Autorange enabled"); } // report autorange was enabled
+    else {
+       Bridge_SerialPrintLn("Autorange disabled"); } // report autorange was disabled
 
-        Bridge_SerialPrint(SETGAIN_RESP_V1);  // report autorange was enabled
-        Bridge_SerialPrintLn(String(resultA));
-        Bridge_SerialPrint(SETGAIN_RESP_I1);  // report autorange was enabled
-        Bridge_SerialPrintLn(String(resultB));
-        Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+    Bridge_SerialPrint(SETGAIN_RESP_V1);  // report autorange was enabled
+    Out_UInt(resultA);
+    Bridge_SerialPrintLn();
+    Bridge_SerialPrint(SETGAIN_RESP_I1);  // report autorange was enabled
+    Out_UInt(resultB);
+    Bridge_SerialPrintLn();
+    Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
 
-      } // was read gain command
+  } // was read gain command
 
-      if (flag_V_I_gain)   // check is we already detected vgain or igain for writing settings
-      {
+  if (flag_V_I_gain)   // check is we already detected vgain or igain for writing settings
+  {
   //--------- WRITE SETGAIN setttings (which disables the autogain)
-        resultA = atoi(sub2);  // this is the extracted value of gain as integer from argument2 
-        SingleParamReadWrite_waitDone(grCommand, 0, resultA, WRITE_MODE); // write the value
-        if (IsOK_Report_Err_Warn("SetGain", grCommand))   // check if no warnings and errors
-        {
-          SingleParamReadWrite_waitDone(CMD_ENABLE_AUTORANGE, 0, 0, WRITE_MODE); // disable autorange
-          if (IsOK_Report_Err_Warn("Autorange update", grCommand))   // check if no warnings and errors
-          {
-            Bridge_SerialPrint(reportStr);     // the command name
-            Bridge_SerialPrintLn(String(resultA));  // report the integer response
-
-            Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
-          } // was OK disable autorange
-        } // was OK when setting the range
-      }  // we needed some extra work on V/I gains      
-    }  // was setgain command
-
-  //===========================================================================
-  //---------- CAN'T FIND COMMND - THIS IS NOT SUPPORTED ----------------------    
-  //===========================================================================
-  else  {  //can't find command
-      Bridge_SerialPrintLn("Error : Non supported command!");  // report the integer response
-      Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands 
-    } // command not recognized
-  } // non group processing commands
+    resultA = atoi(sub2);  // this is the extracted value of gain as integer from argument2 
+    SingleParamReadWrite_waitDone(grCommand, 0, resultA, WRITE_MODE); // write the value
+    if (IsOK_Report_Err_Warn("SetGain", grCommand))   // check if no warnings and errors
+    {
+      SingleParamReadWrite_waitDone(CMD_ENABLE_AUTORANGE, 0, 0, WRITE_MODE); // disable autorange
+      Shadow_NoteWrite(CMD_ENABLE_AUTORANGE, 0);  // autorange off - gains can be kept
+      Shadow_NoteWrite(grCommand, resultA);
+      if (IsOK_Report_Err_Warn("Autorange update", grCommand))   // check if no warnings and errors
+      {
+        Bridge_SerialPrint(reportStr);     // the command name
+        Out_UInt(resultA);  // report the integer response
+        Bridge_SerialPrintLn();
+
+        Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+      } // was OK disable autorange
+    } // was OK when setting the range
+  }  // we needed some extra work on V/I gains      
+} // end of <Cmnd_SetGain>
+
+//================================================================
+// Whole decimal number within minVal..maxVal - atol() would turn "abc" into 0
+//================================================================
+bool Parse_Long(const char str[], long minVal, long maxVal, long *value)
+{
+  char *endPos;
+  long val = strtol(str, &endPos, 10);
+  if ((endPos == str) || (*endPos != char(0)) || (val < minVal) || (val > maxVal)) {
+    return false;                    // not a number, something after it or out of range
+  }
+  *value = val;
+  return true;
+} // end of <Parse_Long>
+
+//================================================================
+// DRAIN command - time budget for one pass of pulling Z records from FIFO
+//================================================================
+void Cmnd_Drain(const cmndEntry_t *cmnd)
+{
+  long budget;
+  if (strcmp(sub1, VOID_STR) != 0) { // we have some data in argument 1 - new budget in us
+    if (Parse_Long(sub1, 0, MAX_DRAIN_BUDGET_US, &budget)) {
+      drainBudget_us = budget;       // 0 will return to one record per tick
+    }
+    else {
+      Bridge_SerialPrintLn("Error : Wrong argument");
+    }
+  } // was write
+
+  Bridge_SerialPrint(sub0);                   // the command name
+  Bridge_SerialPrint(" = ");                  // equals
+  Out_UInt(drainBudget_us); // report the budget
+  Bridge_SerialPrintLn(DRAIN_POS_STR);        // add the pos string
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_Drain>
+
+//================================================================
+// SPI_TIMING command - gaps used by Single_ADMX_Frame (safe, fast or <byte> <ss> <frame> in us)
+//================================================================
+void Cmnd_SpiTiming(const cmndEntry_t *cmnd)
+{
+  if (strcmp(sub1, SPI_TIMING_SAFE1) == 0) {
+    spiTiming = {GAP_BETWEEN_BYTES, SS_CLEARANCE_TIME, GAP_BETWEEN_TRANSMISSIONS};  // original timing
+  }
+  else if (strcmp(sub1, SPI_TIMING_FAST1) == 0) {
+    spiTiming = {FAST_GAP_BETWEEN_BYTES, FAST_SS_CLEARANCE_TIME, FAST_GAP_BETWEEN_TRANSMISSIONS};  // one call per frame
+  }
+  else if (strcmp(sub1, VOID_STR) != 0) { // custom profile - all three values are needed
+    long byteGap, ssClearance, frameGap;
+    if (Parse_Long(sub1, 0, MAX_SPI_GAP_US, &byteGap) && Parse_Long(sub2, 0, MAX_SPI_GAP_US, &ssClearance) &&
+        Parse_Long(sub3, 0, MAX_SPI_GAP_US, &frameGap)) {
+      spiTiming.byteGap_us     = byteGap;
+      spiTiming.ssClearance_us = ssClearance;
+      spiTiming.frameGap_us    = frameGap;
+    }
+    else {               // nothing is changed - a wrapped uint16 would be worse than the old profile
+      Bridge_SerialPrintLn("Error : spi_timing needs safe, fast or <byte> <ss> <frame> gaps in us (0..1000)");
+    }
+  }
+
+  Bridge_SerialPrint(sub0);           // the command name
+  Bridge_SerialPrint(" = byte ");
+  Out_UInt(spiTiming.byteGap_us);
+  Bridge_SerialPrint("us, ss ");
+  Out_UInt(spiTiming.ssClearance_us);
+  Bridge_SerialPrint("us, frame ");
+  Out_UInt(spiTiming.frameGap_us);
+  Bridge_SerialPrintLn("us");
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_SpiTiming>
+
+//================================================================
+// SHADOW command - answer parameter reads from the shadow copy (on/off/clear)
+//================================================================
+void Cmnd_Shadow(const cmndEntry_t *cmnd)
+{
+  if (strcmp(sub1, SHADOW_ON1) == 0) {
+    shadowEnabled = true;            // reads from the copy
+  }
+  else if (strcmp(sub1, SHADOW_OFF1) == 0) {
+    shadowEnabled = false;           // every read goes to the module
+  }
+  else if (strcmp(sub1, SHADOW_CLEAR1) == 0) {
+    Shadow_InvalidateAll();          // forget all values
+  }
+  else if (strcmp(sub1, VOID_STR) != 0) { // not read and not recognized
+    Bridge_SerialPrintLn("Error : Wrong enum argument");
+  }
+
+  Bridge_SerialPrint(sub0);          // the command name
+  Bridge_SerialPrint(" = ");         // equals
+  Bridge_SerialPrint(shadowEnabled ? SHADOW_ON1 : SHADOW_OFF1);
+  Bridge_SerialPrint(", cached ");
+  Out_Int(Shadow_ValidCount());
+  Bridge_SerialPrintLn();
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_Shadow>
+
+//================================================================
+// LEAN command - warning codes read only when they are reported
+//================================================================
+void Cmnd_Lean(const cmndEntry_t *cmnd)
+{
+  if (strcmp(sub1, LEAN_ON1) == 0) {
+    leanMode = true;                 // status only, warnings on demand
+  }
+  else if (strcmp(sub1, LEAN_OFF1) == 0) {
+    leanMode = false;                // every command with WARN bit reads the warning codes
+    warningsPending = false;
+  }
+  else if (strcmp(sub1, VOID_STR) != 0) { // not read and not recognized
+    Bridge_SerialPrintLn("Error : Wrong enum argument");
+  }
+
+  Bridge_SerialPrint(sub0);          // the command name
+  Bridge_SerialPrint(" = ");         // equals
+  Bridge_SerialPrintLn(leanMode ? LEAN_ON1 : LEAN_OFF1);
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_Lean>
+
+//================================================================
+// ZFORMAT command - output format of Z records (ascii or binary)
+//================================================================
+void Cmnd_ZFormat(const cmndEntry_t *cmnd)
+{
+  if (strcmp(sub1, ZFORMAT_ASCII1) == 0) {
+    zOutFormat = ZFMT_ASCII;         // text records as in ADMX CLI
+  }
+  else if (strcmp(sub1, ZFORMAT_BINARY1) == 0) {
+    zOutFormat = ZFMT_BINARY;        // binary records, no float formatting
+  }
+  else if (strcmp(sub1, VOID_STR) != 0) { // not read and not recognized
+    Bridge_SerialPrintLn("Error : Wrong enum argument");
+  }
+
+  Bridge_SerialPrint(sub0);          // the command name
+  Bridge_SerialPrint(" = ");         // equals
+  Bridge_SerialPrintLn((zOutFormat == ZFMT_BINARY) ? ZFORMAT_BINARY1 : ZFORMAT_ASCII1);
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_ZFormat>
+
+//================================================================
+// STATS command - runtime counters, <stats reset> clears them
+//================================================================
+void Cmnd_Stats(const cmndEntry_t *cmnd)
+{
+  if (strcmp(sub1, STATS_RESET1) == 0) {
+    Stats_Reset();
+    Bridge_SerialPrintLn("stats = reset");
+  }
+  else if (strcmp(sub1, VOID_STR) == 0) {
+    Stats_Report();
+  }
+  else {
+    Bridge_SerialPrintLn("Error : Wrong enum argument");
+  }
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_Stats>
+
+//================================================================
+// TRACE command - SPI frames into RAM ring, frozen on error/timeout
+//================================================================
+void Cmnd_Trace(const cmndEntry_t *cmnd)
+{
+  if (strcmp(sub1, TRACE_ARM1) == 0) {
+    Trace_Arm();                     // record from now, freeze on error
+  }
+  else if (strcmp(sub1, TRACE_OFF1) == 0) {
+    Trace_Off();
+  }
+  else if (strcmp(sub1, TRACE_FREEZE1) == 0) {
+    Trace_Freeze();                  // manual freeze - keeps what we have
+  }
+  else if (strcmp(sub1, TRACE_DUMP1) == 0) {
+    Trace_Dump();                    // the report line + all frames
+    Bridge_SerialPrintDelimiter();
+    return;
+  }
+  else if (strcmp(sub1, VOID_STR) != 0) { // not read and not recognized
+    Bridge_SerialPrintLn("Error : Wrong enum argument");
+  }
+  Trace_Report();
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_Trace>
+
+//================================================================
+// LATENCY command - learned DONE latency per command, <latency on|off|reset>
+//================================================================
+void Cmnd_Latency(const cmndEntry_t *cmnd)
+{
+  if (strcmp(sub1, LATENCY_ON1) == 0) {
+    latencyAdaptive = true;          // pre-wait and backoff
+  }
+  else if (strcmp(sub1, LATENCY_OFF1) == 0) {
+    latencyAdaptive = false;         // fixed polling, still learning
+  }
+  else if (strcmp(sub1, LATENCY_RESET1) == 0) {
+    Latency_Reset();
+  }
+  else if (strcmp(sub1, VOID_STR) != 0) { // not read and not recognized
+    Bridge_SerialPrintLn("Error : Wrong enum argument");
+  }
+  Latency_Report();
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_Latency>
+
+//================================================================
+// RXFLOW command - receive flow control and free space of the receive queues
+//================================================================
+void Cmnd_RxFlow(const cmndEntry_t *cmnd)
+{
+  static const char *flowName[] = {RXFLOW_OFF1, RXFLOW_USB1, RXFLOW_XON1};   // same order as rxFlow_t
+
+  if (strcmp(sub1, RXFLOW_USB1) == 0) {
+    RxFlow_Leave();
+    rxFlowMode = RX_FLOW_USB;        // stop reading near full (default)
+  }
+  else if (strcmp(sub1, RXFLOW_XON1) == 0) {
+    rxFlowMode = RX_FLOW_XON;        // XOFF/XON to the host
+  }
+  else if (strcmp(sub1, RXFLOW_OFF1) == 0) {
+    RxFlow_Leave();
+    rxFlowMode = RX_FLOW_OFF;        // no backpressure, overflows are reported
+  }
+  else if (strcmp(sub1, VOID_STR) != 0) { // not read and not recognized
+    Bridge_SerialPrintLn("Error : Wrong enum argument");
+  }
+
+  Bridge_SerialPrint(sub0);          // the command name
+  Bridge_SerialPrint(" = ");         // equals
+  Bridge_SerialPrint(flowName[rxFlowMode]);
+  Bridge_SerialPrint(", free = ");
+  Out_Int(RxFree_Chars());
+  Out_Char('/');
+  Out_Int(SIZE_RECEIVER_QUEUE);
+  Bridge_SerialPrint(" chars, ");
+  Out_Int(RxFree_Lines());
+  Out_Char('/');
+  Out_Int(SIZE_RECORD_LEN_QUEUE);
+  Bridge_SerialPrint(" lines, overflows = ");
+  Out_UInt(rxOverflows);
+  Bridge_SerialPrintLn();
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_RxFlow>
+
+//================================================================
+// STATUS command - what the bridge is doing
+//================================================================
+void Print_BridgeStatus(void)
+{
+  static const char *stateName[] = {"idle", "z", "cal", "commit", "erase", "reload"};   // same order as stateMeasureZ_t
+
+  Bridge_SerialPrint("status = ");
+  Bridge_SerialPrint(stateName[stateMeasureZ]);
+  if (Sweep_Active()) {
+    Bridge_SerialPrint(" (sweep)");
+  }
+  Bridge_SerialPrint(", queued = ");
+  Out_Int(SIZE_RECORD_LEN_QUEUE - RxFree_Lines());
+  Bridge_SerialPrint(", fifo = ");
+  Out_Int(depthFIFO);
+  Bridge_SerialPrintLn();
+}
+
+void Cmnd_Status(const cmndEntry_t *cmnd)
+{
+  Print_BridgeStatus();
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_Status>
+
+//================================================================
+// Held receiver - only lines which can be abort/status/stats are read on (leading spaces allowed)
+//================================================================
+bool Priority_FirstChar(char ch)
+{
+  return (ch == ' ') || (ch == ABORT0[0]) || (ch == STATUS0[0]) || (ch == STATS0[0]);
+}
+
+//================================================================
+// Priority lane - while z/calibrate runs, these lines are not queued but executed when received
+// only the bare command (no arguments), the response gets its own delimiter even in a batch
+//================================================================
+bool Priority_Command(const char line[])
+{
+  while (*line == ' ') {
+    line++;
+  }
+  int len = strlen(line);
+  while ((len > 0) && (line[len - 1] == ' ')) {
+    len--;
+  }
+
+  bool isAbort  = (len == (int)strlen(ABORT0))  && (strncmp(line, ABORT0,  len) == 0);
+  bool isStatus = (len == (int)strlen(STATUS0)) && (strncmp(line, STATUS0, len) == 0);
+  bool isStats  = (len == (int)strlen(STATS0))  && (strncmp(line, STATS0,  len) == 0);
+  if (isAbort && (stateMeasureZ != ACTIVE_Z) && (stateMeasureZ != ACTIVE_CAL)) {
+    return false;   // commit/erase/reload write the FLASH - the abort waits in the queue
+  }
+  if (!isAbort && !isStatus && !isStats) {
+    return false;
+  }
+
+  bool keepBatch = batchActive;
+  batchActive = false;            // our response has its own delimiter
+  if (isAbort) {
+    SingleParamReadWrite_waitDone(CMD_ABORT, 0, 0, WRITE_MODE);    // the module stops measuring
+    Flush_FIFO();                 // records of the stopped run are thrown away
+    stateMeasureZ = IDLE;
+    Sweep_Abort(true);            // module already aborted, sweep settings written back
+    if (keepBatch) {
+      Batch_Finish();             // the rest of the ';' line is not executed - summary + its delimiter
+      keepBatch = false;
+    }
+    else {
+      Bridge_SerialPrintDelimiter();   // closes the response of the stopped z/calibrate
+    }
+    Bridge_SerialPrintLn(ABORT0);  // echo, like the queued commands
+    IsOK_Report_Err_Warn("Hardware error6", CMD_ABORT);   // abort has no response of its own, only errors
+    Bridge_SerialPrintDelimiter();   // the abort response ends like any other
+    Out_Flush();
+  }
+  else {
+    Bridge_SerialPrintLn(isStatus ? STATUS0 : STATS0);   // echo
+    if (isStatus) {
+      Print_BridgeStatus();
+    }
+    else {
+      Stats_Report();
+    }
+    Bridge_SerialPrintDelimiter();
+  }
+  batchActive = keepBatch;
+  return true;
+} // end of <Priority_Command>
+
+//================================================================
+// ZSTAMP command - sequence number, drain time and records pending on every Z record
+//================================================================
+void Cmnd_ZStamp(const cmndEntry_t *cmnd)
+{
+  if (strcmp(sub1, ZSTAMP_ON1) == 0) {
+    zStampEnabled = true;            // <counter,Rm,Xm,seq,time_us,pending>
+  }
+  else if (strcmp(sub1, ZSTAMP_OFF1) == 0) {
+    zStampEnabled = false;           // <counter,Rm,Xm>
+  }
+  else if (strcmp(sub1, VOID_STR) != 0) { // not read and not recognized
+    Bridge_SerialPrintLn("Error : Wrong enum argument");
+  }
+
+  Bridge_SerialPrint(sub0);          // the command name
+  Bridge_SerialPrint(" = ");         // equals
+  Bridge_SerialPrint(zStampEnabled ? ZSTAMP_ON1 : ZSTAMP_OFF1);
+  Bridge_SerialPrint(", seq ");
+  Out_UInt(zSequence);               // next sequence number
+  Bridge_SerialPrintLn();
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_ZStamp>
+
+//================================================================
+// ZSTATS command - N, mean, std, min, max of Rm/Xm at the end of every run (every sweep point)
+//================================================================
+void Cmnd_ZStats(const cmndEntry_t *cmnd)
+{
+  if (strcmp(sub1, ZSTATS_ON1) == 0) {
+    zStatsMode = ZSTATS_ONLY;        // only <zstats = ...> per run
+  }
+  else if (strcmp(sub1, ZSTATS_ALL1) == 0) {
+    zStatsMode = ZSTATS_ALL;         // records, then <zstats = ...>
+  }
+  else if (strcmp(sub1, ZSTATS_OFF1) == 0) {
+    zStatsMode = ZSTATS_OFF;         // records only
+  }
+  else if (strcmp(sub1, VOID_STR) != 0) { // not read and not recognized
+    Bridge_SerialPrintLn("Error : Wrong enum argument");
+  }
+
+  Bridge_SerialPrint(sub0);          // the command name
+  Bridge_SerialPrint(" = ");         // equals
+  Bridge_SerialPrintLn(zStatsMode == ZSTATS_ONLY ? ZSTATS_ON1 : (zStatsMode == ZSTATS_ALL ? ZSTATS_ALL1 : ZSTATS_OFF1));
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_ZStats>
+
+//================================================================
+// ZDERIVED command - <zderived q1 q2 ...> the records carry these quantities (same order), <zderived off> raw Rm/Xm
+//================================================================
+const char * const zDerivedNames[ZD_NUM] = {ZDERIVED_Z1, ZDERIVED_PHASE1, ZDERIVED_RS1, ZDERIVED_XS1, ZDERIVED_CS1, ZDERIVED_CP1,
+                                            ZDERIVED_LS1, ZDERIVED_LP1, ZDERIVED_RP1, ZDERIVED_D1, ZDERIVED_Q1};  // same order as zDerived_t
+
+void Cmnd_ZDerived(const cmndEntry_t *cmnd)
+{
+  if (strcmp(sub1, ZDERIVED_OFF1) == 0) {
+    zDerivedCount = 0;               // <counter,Rm,Xm>
+  }
+  else if (strcmp(sub1, VOID_STR) != 0) {
+    byte newList[ZDERIVED_MAX];
+    int newCount = 0;
+    bool listOK = (numTokens - 1 <= ZDERIVED_MAX);
+    for (int ii = 1; (ii < numTokens) && listOK; ii++) {
+      int qq = 0;
+      while ((qq < ZD_NUM) && (strcmp(Command_Token(ii), zDerivedNames[qq]) != 0)) {
+        qq++;                        // next known quantity
+      }
+      if (qq == ZD_NUM) {
+        listOK = false;              // not a known quantity
+      }
+      else {
+        newList[newCount++] = (byte)qq;
+      }
+    }
+    if (listOK) {                    // all or nothing - the host keeps its column list
+      memcpy(zDerivedList, newList, newCount);
+      zDerivedCount = newCount;
+    }
+    else {
+      Bridge_SerialPrintLn("Error : Wrong enum argument");
+    }
+  }
+
+  Bridge_SerialPrint(sub0);          // the command name
+  Bridge_SerialPrint(" = ");         // equals
+  if (zDerivedCount == 0) {
+    Bridge_SerialPrint(ZDERIVED_OFF1);
+  }
+  for (int ii = 0; ii < zDerivedCount; ii++) {
+    if (ii > 0) {
+      Bridge_SerialPrint(",");
+    }
+    Bridge_SerialPrint(zDerivedNames[zDerivedList[ii]]);
+  }
+  Bridge_SerialPrintLn();
+  Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands
+} // end of <Cmnd_ZDerived>
+
+
+//================================================================
+// COMMAND TABLE - sorted by name (checked at compile time), searched with binary search
+// PARAM(name, read opcode, write opcode, read type, write type, scaling, post string, enum names...) - generic read/write
+// SPECIAL(name, handler) - commands which need special treatment
+//================================================================
+#define PARAM(name, rdOp, wrOp, typeRd, typeWr, scaling, posStr, ...)  { name, Cmnd_Param, rdOp, wrOp, typeRd, typeWr, scaling, posStr, { __VA_ARGS__ } }
+#define SPECIAL(name, handler)                                          { name, handler, CMD_NOT_DEFINED, CMD_NOT_DEFINED, INT_T, INT_T, 1, VOID_STR, { } }
+
+constexpr cmndEntry_t cmndTable[] = {
+  SPECIAL(IDN0,         Cmnd_Idn),
+  SPECIAL(ABORT0,       Cmnd_Abort),
+  PARAM  (AVERAGE0,     CMD_AVERAGE,      CMD_AVERAGE,      INT_T,   INT_T,   1,    VOID_STR),
+  SPECIAL(CALIBRATE0,   Cmnd_Calibrate),
+  PARAM  (COUNT0,       CMD_COUNT,        CMD_COUNT,        INT_T,   INT_T,   1,    VOID_STR),
+  PARAM  (CYCLES0,      CMD_CYCLES,       CMD_CYCLES,       INT_T,   INT_T,   1,    VOID_STR),
+  PARAM  (DISPLAY0,     CMD_DISPLAY,      CMD_DISPLAY,      INT_T,   INT_T,   1,    VOID_STR),
+  SPECIAL(DRAIN0,       Cmnd_Drain),
+  PARAM  (FREQUENCY0,   CMD_FREQUENCY,    CMD_FREQUENCY,    FLOAT_T, FLOAT_T, 1000, FREQUENCY_POS_STR),
+  PARAM  (GPIO_CTRL0,   CMD_SET_GPIO,     CMD_SET_GPIO,     INT_T,   INT_T,   1,    VOID_STR),
+  PARAM  (INTEGRATION0, CMD_INTEGRATION,  CMD_INTEGRATION,  FLOAT_T, FLOAT_T, 1,    VOID_STR),
+  SPECIAL(LATENCY0,     Cmnd_Latency),
+  SPECIAL(LEAN0,        Cmnd_Lean),
+  PARAM  (MAGNITUDE0,   CMD_MAGNITUDE,    CMD_MAGNITUDE,    FLOAT_T, FLOAT_T, 1,    VOID_STR),   // don't show the volts
+  PARAM  (MDELAY0,      CMD_MDELAY,       CMD_MDELAY,       FLOAT_T, FLOAT_T, 1,    MDELAY_POS_STR),
+  PARAM  (OFFSET0,      CMD_OFFSET,       CMD_OFFSET,       FLOAT_T, FLOAT_T, 1,    VOID_STR),   // don't show the volts
+  SPECIAL(READCAL0,     Cmnd_ReadCal),
+  SPECIAL(READCALALL0,  Cmnd_ReadCalAll),
+  SPECIAL(RESET0,       Cmnd_Reset),
+  SPECIAL(RESETCAL0,    Cmnd_ResetCal),
+  SPECIAL(RXFLOW0,      Cmnd_RxFlow),
+  SPECIAL(SETGAIN0,     Cmnd_SetGain),
+  SPECIAL(SHADOW0,      Cmnd_Shadow),
+  SPECIAL(SPI_TIMING0,  Cmnd_SpiTiming),
+  SPECIAL(STATS0,       Cmnd_Stats),
+  SPECIAL(STATUS0,      Cmnd_Status),
+  SPECIAL(STORECAL0,    Cmnd_StoreCal),
+  SPECIAL(SWEEP0,       Cmnd_Sweep),
+  PARAM  (SWEEP_SCALE0, CMD_SWEEP_SCALE,  CMD_SWEEP_SCALE,  ENUM_T,  ENUM_T,  1,    VOID_STR, SWEEP_SCALE_LIN1, SWEEP_SCALE_LOG1),
+  PARAM  (SWEEPTYPE0,   CMD_SWEEP_TYPE,   CMD_SWEEP_TYPE,   ENUM_T,  ENUM_T,  1,    VOID_STR, SWEEPTYPE_OFF1, SWEEPTYPE_FREQ1, SWEEPTYPE_MAGN1, SWEEPTYPE_OFFSET1),
+  PARAM  (TCOUNT0,      CMD_TCOUNT,       CMD_TCOUNT,       INT_T,   INT_T,   1,    VOID_STR),
+  PARAM  (TDELAY0,      CMD_TDELAY,       CMD_TDELAY,       FLOAT_T, FLOAT_T, 1,    TDELAY_POS_STR),
+  PARAM  (TEMPERAT0,    CMD_TEMPERATURE,  CMD_CELSIUS,      FLOAT_T, ENUM_T,  1,    VOID_STR, TEMP_FARENHEIT, TEMP_CELSIUS),  // read the temperature, write the units
+  SPECIAL(TRACE0,       Cmnd_Trace),
+  PARAM  (TRIG_MODE0,   CMD_TRIGGER_MODE, CMD_TRIGGER_MODE, ENUM_T,  ENUM_T,  1,    VOID_STR, TRIG_MODE_INT, TRIG_MODE_EXT),
+  SPECIAL(CMND_VOID,    Cmnd_Void),
+  SPECIAL(MEAS_Z0,      Cmnd_MeasureZ),
+  SPECIAL(ZDERIVED0,    Cmnd_ZDerived),
+  SPECIAL(ZFORMAT0,     Cmnd_ZFormat),
+  SPECIAL(ZSTAMP0,      Cmnd_ZStamp),
+  SPECIAL(ZSTATS0,      Cmnd_ZStats),
+};
+#define NUM_OF_COMMANDS  (sizeof(cmndTable) / sizeof(cmndTable[0]))
+
+//--------- the enum names are stored by value
+static_assert((TEMP_FARENHEIT_VAL == 0) && (TEMP_CELSIUS_VAL == 1), "temperature units order in cmndTable");
+static_assert((TRIG_MODE_INTER_VAL == 0) && (TRIG_MODE_EXTERN_VAL == 1), "trigger mode order in cmndTable");
+static_assert((SWEEP_SCALE_LIN_VAL == 0) && (SWEEP_SCALE_LOG_VAL == 1), "sweep scale order in cmndTable");
+
+//--------- the binary search needs the names in strcmp() order
+constexpr int ConstStrCmp(const char *strA, const char *strB)
+{
+  while ((*strA != char(0)) && (*strA == *strB)) {
+    strA++;
+    strB++;
+  }
+  return (unsigned char)*strA - (unsigned char)*strB;
+}
+
+constexpr bool IsCmndTableSorted(void)
+{
+  for (unsigned int ii = 1; ii < NUM_OF_COMMANDS; ii++) {
+    if (ConstStrCmp(cmndTable[ii-1].name, cmndTable[ii].name) >= 0) {
+      return false;
+    }
+  }
+  return true;
+}
+static_assert(IsCmndTableSorted(), "cmndTable must be sorted by name (strcmp order) and without duplicates");
+
+//================================================================
+// Find the command in the table - NULL if not supported
+//================================================================
+const cmndEntry_t *FindCommand(const char name[])
+{
+  int low = 0;
+  int high = NUM_OF_COMMANDS - 1;
+
+  while (low <= high) {
+    int mid = (low + high) / 2;
+    int cmp = strcmp(name, cmndTable[mid].name);
+    if (cmp == 0) {
+      return &cmndTable[mid];     // found it
+    }
+    if (cmp < 0) {
+      high = mid - 1;             // in the lower half
+    }
+    else {
+      low = mid + 1;              // in the upper half
+    }
+  }
+  return NULL;   // not in the table
+}
+
+//================================================================
+// Main processing of commands - we send SPI commands according to the ANSI commands strings in sub0..sub5
+//================================================================
+void Command_Processor(void)
+{
+  forceHwRead = false;                      // TRUE - read from the module even if we have a shadow copy
+  if (strcmp(sub1, SHADOW_FORCE1) == 0) {   // <frequency ?> - the read skips the shadow copy
+    forceHwRead = true;
+    sub1[0] = char(0);                      // from here on it's a normal read
+  }
+
+  const cmndEntry_t *cmnd = FindCommand(sub0);   // what we have to do
+  if (cmnd != NULL) {
+    cmnd->handler(cmnd);        // process the command
+  }
+  else {  //can't find command
+    Bridge_SerialPrintLn("Error : Non supported command!");  // report the integer response
+    Bridge_SerialPrintDelimiter();   // here we print the special character 0x0C which works as LabView delimiter for the commands 
+  } // command not recognized
 } // end of the command processor
 
 
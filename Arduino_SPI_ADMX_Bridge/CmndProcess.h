@@ -19,6 +19,28 @@
 #define SPI_CLK_PIN  D13       // this is the SPI CLK pin (13) 
 
 #define DATA_DELIMITER  (char(0x0C))     // this is invisible character we can add at the end of the data packet 
+#define COMMAND_STR_LEN      150         // what is the longest control string (whole line) - the receiver doesn't store more of a line
+
+//-------- Binary records (zformat binary) - [SYNC][type][len][payload][checksum]
+// type, len, payload and checksum are byte stuffed: A5, 0C and 7D go out as 7D followed by the byte XOR 20,
+// so DATA_DELIMITER and SYNC never show up inside a record - the host can still read up to 0x0C, then unstuff.
+// len and checksum are of the unstuffed bytes.
+#define BIN_SYNC_BYTE       0xA5         // first byte of every binary record, never used in text output
+#define BIN_ESC_BYTE        0x7D         // next byte is stuffed
+#define BIN_ESC_XOR         0x20         // stuffed byte = original XOR 0x20
+#define BIN_OUT_CHUNK       32           // stuffed bytes go to the TX ring in chunks of this size
+#define BIN_TYPE_Z          0x01         // Z record: counter (U32) + Rm (double) + Xm (double) = raw FIFO words in little endian
+#define BIN_Z_PAYLOAD_LEN   20           // 4 bytes counter + 2 x 8 bytes double
+#define BIN_TYPE_CAL        0x02         // calibration set: vgain, igain (U8) + status, freq, temp (U32) + 12 x double, raw words in little endian
+#define BIN_CAL_PAYLOAD_LEN 110          // 2 + 3 x 4 + 12 x 8 bytes
+#define BIN_CAL_EMPTY_LEN   6            // no coefficients stored - vgain, igain, status
+#define BIN_TYPE_ZF         0x03         // Z record of a sweep: counter (U32) + frequency in Hz (float) + Rm, Xm (double)
+#define BIN_ZF_PAYLOAD_LEN  24           // 4 bytes counter + 4 bytes float + 2 x 8 bytes double
+#define BIN_TYPE_ZSTATS     0x04         // end of run statistics: N (U32) + mean, std, min, max (double) of Rm then Xm
+#define BIN_ZSTATS_PAYLOAD_LEN 68        // 4 bytes N + 8 x 8 bytes double
+#define BIN_TYPE_ZD         0x05         // derived Z record: counter (U32) + frequency in Hz (float) + the selected quantities (double) in the selected order
+#define BIN_ZD_HEADER_LEN   8            // 4 bytes counter + 4 bytes float, then 8 bytes per quantity
+#define BIN_STAMP_LEN       10           // zstamp on - Z records end with sequence (U32) + micros() (U32) + records pending estimate (U16)
 
 //-------- STATE machine Z measure
 // when IDLE - there is no active Z measurement, don't do anything
@@ -26,13 +48,48 @@
 enum stateMeasureZ_t {IDLE, ACTIVE_Z, ACTIVE_CAL, ACTIVE_COMMIT_CAL, ACTIVE_CALIBRATE_ERASE, ACTIVE_RELOAD_CAL};  
 enum readWrite_t {READ_MODE, WRITE_MODE}; // used in read/write attributes
 enum errorWarn_t {ERROR_MSG, WARN_MSG};   // error or warning message type
-#define  SIZE_SUB_ARRAY   20     // what is the longest string we can process (like sweep_type - 10chr or error_check - 11chr)
+enum argum_t {FLOAT_T, INT_T, ENUM_T};    // the type of conversion of the command argument/response
+
+//-------- Command table entry - commands are found by name in the sorted cmndTable[] (CmndProcess.cpp)
+#define MAX_CMND_ENUMS   4       // up to 4 verbose values (like sweep_type off/frequency/magnitude/offset)
+struct cmndEntry_t {
+  const char *name;                             // the command (sub0)
+  void (*handler)(const cmndEntry_t *cmnd);     // Cmnd_Param() for the generic read/write, or the special handler
+  byte rdOpcode;                                // SPI command for reading
+  byte wrOpcode;                                // SPI command for writing (temperature reads 0x0E, but writes the units 0x3B)
+  argum_t typeRd;                               // conversion of the read response
+  argum_t typeWr;                               // conversion of the write argument
+  float scaling;                                // frequency is reported in kHz, the module uses Hz
+  const char *posStr;                           // post string like kHz or msec
+  const char *enumStr[MAX_CMND_ENUMS];          // verbose names of the enum values 0..3 (NULL - not used)
+};
+#define  SIZE_SUB_ARRAY   20     // text buffers for the numbers (the command tokens are not limited by it any more)
+
+//-------- SPI frame timing (all in us), selected at runtime with <spi_timing>
+struct spiTiming_t {
+  uint16_t byteGap_us;       // gap between the 7 bytes of a frame, 0 - the frame is sent in one SPI.transfer() call
+  uint16_t ssClearance_us;   // gap between SS edge and first/last clock
+  uint16_t frameGap_us;      // minimum time from the end of the previous frame (SS high) to the next SS low
+};
+#define GAP_BETWEEN_BYTES               4   // safe profile - how many microseconds to have between bytes
+#define SS_CLEARANCE_TIME               4   // safe profile - gap between SS going low or high and first/last pulse
+#define GAP_BETWEEN_TRANSMISSIONS      40   // safe profile - minimum time is 40 us
+#define FAST_GAP_BETWEEN_BYTES          0   // fast profile - whole frame in one transfer
+#define FAST_SS_CLEARANCE_TIME          1   // fast profile - SS setup/hold
+#define FAST_GAP_BETWEEN_TRANSMISSIONS 20   // fast profile - the time we spend between frames counts into it
+#define MAX_SPI_GAP_US               1000   // <spi_timing> custom gaps are checked against this (fields are uint16)
 
 
 //--------- Function prototypes -----------------------------------------------------------
-void CommandSplitter(int cmndLen);
+void Command_Begin(void);             // new line into commandStr
+void Command_AddChar(char curChar);   // one char of the line - the tokens are found on the go
+int  Command_End(void);               // line complete - its length, -1 if it was too long
+bool CommandSplitter(void);           // sub0..sub4 point to the tokens, FALSE - the line was reported as error
+char *Command_Token(int index);       // any token of the line (void string if not there)
 void Command_Processor();
+const cmndEntry_t *FindCommand(const char name[]);  // binary search in the command table, NULL if not supported
 uint32_t Single_ADMX_Frame(byte command, uint16_t address, uint32_t dataOut);
+bool ADMX_FrameGapElapsed(void);   // TRUE if Single_ADMX_Frame() can start without waiting
 bool IsOK_Report_Err_Warn(const char custMessage[], byte custCommand);  // we can accept the warnings or not 
 
 
@@ -49,12 +106,23 @@ uint32_t WaitForDoneAndGetStatus(int max_number_wait = DEFAULT_MAX_NUMBER_WAIT);
 void Clear_ADMX_SPI_Errors(void);  // clear the errors of SPI and reset the SPI engine - notice that using too often this function can cause problems
 void PrintErrWarnMessage(byte forCommand, const char custMsgStr[], const char msgString[], errorWarn_t msgType);
 void CheckStatus_and_Warnings(void); 
+bool Priority_Command(const char line[]);  // busy bridge - abort/status/stats executed at receive time, FALSE if not such command
+bool Priority_FirstChar(char ch);          // TRUE if a line starting with ch can be a priority command
+void MeasureZ_Start(void);         // start Z run (ACTIVE_Z) - <z> and the sweep points
+void FetchPendingWarnings(void);   // lean mode - read the warning codes of the last command (if not read yet)
 
 void InitialiseSPI(void);
 
-void Bridge_SerialPrint(String myStr);
-void Bridge_SerialPrintLn(String myStr);
+void Bridge_SerialPrint(const char myStr[]);          // strings go into the TX ring (SerialOut.h), numbers with Out_UInt()/Out_Float()...
+void Bridge_SerialPrintLn(const char myStr[] = "");   // with line end, without argument only the line end
 void Bridge_SerialPrintDelimiter(void) ;
+void Bridge_SerialWriteRecord(byte recType, const byte payload[], byte payloadLen);  // binary record with header and checksum
+
+#define MAX_BATCH_FAILED   16    // how many failed command numbers we list in the batch summary
+void Batch_Start(int lineLen);   // commandStr holds a ';' separated line - keep it for Batch_NextCommand()
+int  Batch_NextCommand(void);    // copy the next command of the batch into commandStr, -1 when no more commands
+void Batch_Finish(void);         // print the summary and the single delimiter of the batch
+void Batch_Abort(void);          // bridge reset - forget the batch without output
 
 #define STATUS_POLLING_TIME_uS   25   // we poll the status on regular intervals to clam down the communication
  
@@ -65,8 +133,12 @@ void Bridge_SerialPrintDelimiter(void) ;
 #define ConvDoubleToInt64(doubleVal)    (*(uint64_t*)&doubleVal)   // macros for converting doable to integer64
 
 
+extern spiTiming_t spiTiming;   // current SPI frame timing
 extern char commandStr[];    // here we accumulate the data from the buffer and we have some limit of max len of string per line
-extern char sub0[], sub1[], sub2[], sub3[], sub4[];  // substring commands
+extern bool batchActive;     // TRUE while the commands of a ';' line are executed
+extern bool leanMode;        // TRUE - warning codes are read only when the message is printed
+extern char *sub0, *sub1, *sub2, *sub3, *sub4;  // the command and its first 4 arguments (tokens of commandStr)
+extern int  numTokens;       // tokens of the line - the arguments beyond sub4 are read with Command_Token()
 
 
 
@@ -0,0 +1,148 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Fast "%.7e" formatting of the measurement results
+// IDEX Biometrics UK
+//
+// 17-10-26 -- Creating the file
+// 17-10-26 -- Exponent from the double bits and integer mantissa - the RA4M1 FPU is single precision,
+//             so every double operation is a library call: only the scaling is left in double
+//================================================================
+#include <stdio.h>          // snprintf() for the values we don't handle
+#include <stdint.h>
+#include <string.h>         // memcpy() for the double bits
+#include "FastFormat.h"
+
+#define SCI7_DIGITS         8        // 1 digit before and 7 after the point
+#define SCI7_MANT_MIN       10000000UL
+#define SCI7_MANT_MAX       99999999UL
+#define SCI7_MAX_SHIFT      22       // 10^22 is the largest power of 10 which is exact in double
+#define SCI7_LOG10_2_Q18    78913    // log10(2) * 2^18 - floor(e * log10(2)) = (e * 78913) >> 18 for |e| < 1650
+#define SCI7_FIXED_9DIGITS  (100000000ULL << 32)  // 1e8 as 32.32 fixed point - the exponent guess was one low
+#define SCI7_HALF_Q32       0x80000000UL          // 0.5 as the 32 bit fraction
+#define SCI7_TIE_MARGIN_Q32 4295     // 1e-6 * 2^32 - scaling error is < 1.5e-8, so outside of this margin the rounding is certain
+#define DBL_EXP_MASK        0x7FF    // biased exponent bits of a double
+#define DBL_EXP_BIAS        1023
+#define DBL_MANT_BITS       52
+#define DBL_MANT_MASK       ((1ULL << DBL_MANT_BITS) - 1)
+
+unsigned long sci7Fallbacks = 0;     // how many values went to snprintf()
+
+static const double pow10Exact[SCI7_MAX_SHIFT + 1] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+//================================================================
+// val * 10^shift with a single rounding, FALSE if the power is not exact
+//================================================================
+static bool ScaleByPow10(double val, int shift, double *scaled)
+{
+  if ((shift > SCI7_MAX_SHIFT) || (shift < -SCI7_MAX_SHIFT)) {
+    return false;
+  }
+  *scaled = (shift >= 0) ? val * pow10Exact[shift] : val / pow10Exact[-shift];
+  return true;
+}
+
+//================================================================
+static int FormatSci7_Fallback(double val, char outStr[])
+{
+  sci7Fallbacks++;
+  return snprintf(outStr, SCI7_BUF_LEN, "%.7e", val);
+}
+
+//================================================================
+// Same text as sprintf(outStr, "%.7e", val) - <d.ddddddde+XX>
+//================================================================
+int FormatSci7(double val, char outStr[])
+{
+  uint64_t bits;
+  memcpy(&bits, &val, sizeof(bits));
+  int biasedExp = (int)((bits >> DBL_MANT_BITS) & DBL_EXP_MASK);
+
+  if (biasedExp == DBL_EXP_MASK) {
+    return FormatSci7_Fallback(val, outStr);   // inf/nan - rare, let the library spell it
+  }
+
+  double origVal = val;                       // the fallback prints it with the sign
+  char *pos = outStr;
+  if (bits >> 63) {                            // -0.0 is printed with the sign too
+    *pos++ = '-';
+    val = -val;
+  }
+
+  int exp10 = 0;
+  uint32_t mant = 0;                           // the 8 digits
+
+  if ((bits << 1) != 0) {                      // not +-0
+    if (biasedExp == 0) {                      // subnormal - far out of the exact powers anyway
+      return FormatSci7_Fallback(origVal, outStr);
+    }
+    // val >= 2^(biasedExp - bias), so floor(log10(val)) is this or one more
+    exp10 = ((biasedExp - DBL_EXP_BIAS) * SCI7_LOG10_2_Q18) >> 18;
+
+    double scaled;                             // the only double operation - in [1e7, 1e9)
+    if (!ScaleByPow10(val, SCI7_DIGITS - 1 - exp10, &scaled)) {
+      return FormatSci7_Fallback(origVal, outStr);
+    }
+
+    //--------- scaled as exact 32.32 fixed point, straight from its bits
+    uint64_t scaledBits;
+    memcpy(&scaledBits, &scaled, sizeof(scaledBits));
+    int shift = (int)((scaledBits >> DBL_MANT_BITS) & DBL_EXP_MASK) - DBL_EXP_BIAS - DBL_MANT_BITS + 32;
+    if ((shift < 0) || (shift > 10)) {         // not in [1e7, 1e9) - should not happen
+      return FormatSci7_Fallback(origVal, outStr);
+    }
+    uint64_t fixed = ((scaledBits & DBL_MANT_MASK) | (1ULL << DBL_MANT_BITS)) << shift;
+    if (fixed >= SCI7_FIXED_9DIGITS) {         // 9 digits - the guess was one low
+      fixed /= 10;
+      exp10++;
+    }
+
+    uint32_t whole = (uint32_t)(fixed >> 32);
+    uint32_t frac  = (uint32_t)fixed;
+    uint32_t fromHalf = (frac >= SCI7_HALF_Q32) ? frac - SCI7_HALF_Q32 : SCI7_HALF_Q32 - frac;
+    if (fromHalf < SCI7_TIE_MARGIN_Q32) {      // too close to a tie - the exact decimal value decides
+      return FormatSci7_Fallback(origVal, outStr);
+    }
+    mant = whole + ((frac > SCI7_HALF_Q32) ? 1 : 0);
+    if (mant > SCI7_MANT_MAX) {                // 9.99999999 rounded up to 10.0000000
+      mant /= 10;
+      exp10++;
+    }
+    if (mant < SCI7_MANT_MIN) {                // should not happen - don't risk a wrong digit
+      return FormatSci7_Fallback(origVal, outStr);
+    }
+  }
+
+  //--------- digits - <d.ddddddd>
+  char digits[SCI7_DIGITS];
+  for (int ii = SCI7_DIGITS - 1; ii >= 0; ii--) {
+    digits[ii] = '0' + (mant % 10);
+    mant /= 10;
+  }
+  *pos++ = digits[0];
+  *pos++ = '.';
+  for (int ii = 1; ii < SCI7_DIGITS; ii++) {
+    *pos++ = digits[ii];
+  }
+
+  //--------- exponent - <e+XX> at least two digits
+  *pos++ = 'e';
+  if (exp10 < 0) {
+    *pos++ = '-';
+    exp10 = -exp10;
+  }
+  else {
+    *pos++ = '+';
+  }
+  if (exp10 >= 100) {
+    *pos++ = '0' + exp10 / 100;
+    exp10 %= 100;
+  }
+  *pos++ = '0' + exp10 / 10;
+  *pos++ = '0' + exp10 % 10;
+  *pos = char(0);
+
+  return pos - outStr;
+}
@@ -0,0 +1,27 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Fast "%.7e" formatting of the measurement results
+// IDEX Biometrics UK
+//
+// The decimal exponent comes from the binary exponent bits, the value is scaled
+// by an exact power of 10 (the only double operation) and its bits give the
+// 8 digits as a fixed point integer. The scaling has one rounding (<= 0.5 ulp),
+// so the result is the same as sprintf() except when the 9th digit is too
+// close to a tie - those values (and inf/nan/very large or small exponents)
+// are passed to snprintf(), so the output is always byte-identical.
+//
+// 17-10-26 -- Creating the file
+//
+//================================================================
+#ifndef _FAST_FORMAT_H
+#define _FAST_FORMAT_H
+
+#define SCI7_BUF_LEN   16      // "-1.2345678e+308" + string end
+
+//--------- Function prototypes -----------------------------------------------------------
+int FormatSci7(double val, char outStr[]);   // same text as sprintf(outStr, "%.7e", val), returns the length
+
+//--------- External variables -----------------------------------------------------------
+extern unsigned long sci7Fallbacks;          // how many values went to snprintf()
+
+#endif // end _FAST_FORMAT_H
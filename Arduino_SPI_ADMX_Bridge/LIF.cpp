@@ -10,6 +10,12 @@
  * MINIMAL DELAY BETWEEN BYTES - 25 uS
  * MINIMAL TIME GAP BETWEEN DATA BLOCKS - 1.5mS (AFTER 1.5mS WILL AUTORESET THE SEQUENCE AND WILL START RECORDING FROM BYTE 0)
  * INPUT BYTE - DATA SEQUENCE - MSBit first, LSBit last (the user should output first MS bit, then LS bits)
+ *
+ * 17-10-26 -- The bytes go into a queue, a timer IRQ shifts out one bit per LIF_BIT_PERIOD_US
+ *             (and waits LIF_GAP_TICKS after each byte), so send_debug_xxx() costs ~1us in the
+ *             caller instead of 40us per byte and the IRQ itself takes ~1.5us, not a whole byte.
+ *             A value (int16/int32) is queued whole or dropped (counted in lifDropped).
+ *             Without a free timer the bytes go out blocking like before.
 ************************************************************************/
 
 
@@ -32,13 +38,24 @@
  ************************************************************************/
   
 #include <Arduino.h>
+#include <FspTimer.h>   // timer driving the output
 #include "LIF.h"    // definitions and prototypes
 
+volatile byte lifQueue[LIF_QUEUE_SIZE];   // bytes waiting for the timer
+volatile byte lifHead = 0;                // written by the main loop
+volatile byte lifTail = 0;                // written by the IRQ
+volatile bool lifRunning = false;         // timer is running (there is something to send)
+byte lifShift = 0;                        // byte being shifted out by the IRQ, MSB next
+byte lifBitsLeft = 0;                     // its bits still to send, 0 - take the next byte
+byte lifGapLeft = 0;                      // idle ticks till the next byte may start
+volatile unsigned long lifDropped = 0;    // values which didn't fit in the queue
+FspTimer lifTimer;
+bool lifTimerReady = false;               // FALSE - no timer, blocking output
+
 //*************************************************************************
-void send_debug_int8(byte datas) 	// procedure to output single to LIF box
+static void Shift_LIF_Byte(byte datas) 	// 8 clocks, MSB first - the byte gap is made by the caller
 //*************************************************************************
 {
-	
   for( byte ii = 8; ii != 0; ii--)
   {	
     int toWrite = (datas & 0x80)? 1: 0;		
@@ -51,40 +68,127 @@ void send_debug_int8(byte datas) 	// procedure to output single to LIF box
     datas <<= 1; /* Shift next bit up, ready for output */
   }
 	digitalWrite(LIF_DATA, LOW);	 // set data again in zero state (it's not neccessary)
-  delayMicroseconds(25);
-} // of of send byte
+} // of of shift byte
+
+//*************************************************************************
+static void LIF_TimerIRQ(timer_callback_args_t *args)  // one bit per period, the byte gap in idle ticks
+//*************************************************************************
+{
+  (void)args;
+  if (lifGapLeft > 0) {       // gap after the byte
+    lifGapLeft--;
+    return;
+  }
+  if (lifBitsLeft == 0) {     // next byte
+    if (lifTail == lifHead) { // all sent - stop till the next value comes
+      lifTimer.stop();
+      lifRunning = false;
+      return;
+    }
+    lifShift = lifQueue[lifTail];
+    lifTail = (lifTail + 1) & LIF_QUEUE_MASK;
+    lifBitsLeft = 8;
+  }
+
+  digitalWrite(LIF_DATA, (lifShift & 0x80)? HIGH: LOW);   // output data
+  digitalWrite(LIF_CLK, HIGH);   // make a CLK pulse - digitalWrite() alone is longer than the 0.33us the box needs
+  digitalWrite(LIF_CLK, LOW);
+  lifShift <<= 1;
+
+  if (--lifBitsLeft == 0) {   // byte done
+    digitalWrite(LIF_DATA, LOW);
+    lifGapLeft = LIF_GAP_TICKS;
+  }
+}
+
+//*************************************************************************
+void LIF_Begin(void)  // get a timer for the output - called from setup() after the pins are set
+//*************************************************************************
+{
+  uint8_t timerType;
+  int8_t timerChannel = FspTimer::get_available_timer(timerType);
+  if (timerChannel < 0) {
+    return;                   // no timer - send_debug_xxx() stays blocking
+  }
+  lifTimerReady = lifTimer.begin(TIMER_MODE_PERIODIC, timerType, timerChannel, 1000000.0f / LIF_BIT_PERIOD_US, 0.0f, LIF_TimerIRQ) &&
+                  lifTimer.setup_overflow_irq() &&
+                  lifTimer.open();
+}
+
+//*************************************************************************
+static void Queue_LIF_Bytes(const byte datas[], int len)  // the whole value or nothing
+//*************************************************************************
+{
+  if (!lifTimerReady) {       // the old way - blocking
+    for (int ii = 0; ii < len; ii++) {
+      Shift_LIF_Byte(datas[ii]);
+      delayMicroseconds(LIF_BYTE_GAP_US);
+    }
+    return;
+  }
+
+  noInterrupts();
+  int freeSpace = (lifTail - lifHead - 1) & LIF_QUEUE_MASK;
+  if (freeSpace < len) {
+    lifDropped++;
+  }
+  else {
+    for (int ii = 0; ii < len; ii++) {
+      lifQueue[lifHead] = datas[ii];
+      lifHead = (lifHead + 1) & LIF_QUEUE_MASK;
+    }
+    if (!lifRunning) {        // the first byte goes out one period from now
+      lifRunning = true;
+      lifTimer.start();
+    }
+  }
+  interrupts();
+}
+
+//*************************************************************************
+void send_debug_int8(byte datas) 	// procedure to output single to LIF box
+//*************************************************************************
+{
+   Queue_LIF_Bytes(&datas, 1);
+}
 
 //************************************************************************
 void send_debug_int16(uint16_t signal16) // send temp16 to LIF (MSB firt)
 //************************************************************************
 {
-   send_debug_int8(signal16 >> 8);             // MSB last
-   send_debug_int8(signal16 & 0xFF);           // LSB first
+   byte datas[2] = {(byte)(signal16 >> 8),            // MSB last
+                    (byte)(signal16 & 0xFF)};         // LSB first
+   Queue_LIF_Bytes(datas, sizeof(datas));
 }
 
 //************************************************************************
 void send_debug_int32(uint32_t signal32) // send temp32 to LIF MSB first
 //************************************************************************
 {
-   send_debug_int8((signal32 >> 24) & 0xFF);    // MSB last  
-   send_debug_int8((signal32 >> 16) & 0xFF);      
-   send_debug_int8((signal32 >> 8) & 0xFF);      
-   send_debug_int8(signal32 & 0xFF);             // LSB first
+   byte datas[4] = {(byte)((signal32 >> 24) & 0xFF),  // MSB last
+                    (byte)((signal32 >> 16) & 0xFF),
+                    (byte)((signal32 >> 8) & 0xFF),
+                    (byte)(signal32 & 0xFF)};         // LSB first
+   Queue_LIF_Bytes(datas, sizeof(datas));
 }
 
 //************************************************************************
 void Pulse_LIF_CLK(void) // mke short pulse on LIF CLK pin
 //************************************************************************
 {
+    noInterrupts();                 // the timer IRQ drives the same pin
     digitalWrite(LIF_CLK, HIGH);		// make a CLK pulse
     digitalWrite(LIF_CLK, LOW);		  // output data		
+    interrupts();
 }
 
 //************************************************************************
 void Pulse_LIF_DATA(void) // mke short pulse on LIF DATA pin
 //************************************************************************
 {
+    noInterrupts();                 // the timer IRQ drives the same pin
     digitalWrite(LIF_DATA, HIGH);		// make a CLK pulse
     digitalWrite(LIF_DATA, LOW);		  // output data		
+    interrupts();
 }
 
@@ -14,10 +14,19 @@
 #define LIF_CLK  		D0	// clock of the debugger
 #define LIF_DATA 		D1	// data of the debugger
 
+#define LIF_QUEUE_SIZE      64  // bytes waiting for the timer - must be power of 2
+#define LIF_QUEUE_MASK      (LIF_QUEUE_SIZE - 1)
+#define LIF_BYTE_GAP_US     25  // minimal delay between bytes
+#define LIF_BIT_PERIOD_US   5   // timer period - one bit (one CLK pulse) per tick, the IRQ stays short
+#define LIF_GAP_TICKS       ((LIF_BYTE_GAP_US + LIF_BIT_PERIOD_US - 1) / LIF_BIT_PERIOD_US)  // idle ticks after a byte
+
+extern volatile unsigned long lifDropped;   // values which didn't fit in the queue
+
+void LIF_Begin(void);               // timer for the queued output - call after the pins are set
 void send_debug_int8(byte datas);   // prototype LIF interface
 void send_debug_int16(uint16_t signal16); // send temp16 to LIF
 void send_debug_int32(uint32_t signal32); // send temp32 to LIF
-void Pulse_LIF_CLK(void); // mke short pulse on LIF CLK pin
-void Pulse_LIF_DATA(void); // mke short pulse on LIF DATA pin
+void Pulse_LIF_CLK(void); // mke short pulse on LIF CLK pin (not in the middle of a queued bit)
+void Pulse_LIF_DATA(void); // mke short pulse on LIF DATA pin (not in the middle of a queued bit)
 
 #endif // end _LIF_H
\ No newline at end of file
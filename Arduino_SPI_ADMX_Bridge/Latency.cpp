@@ -0,0 +1,113 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Learned DONE latency per command
+// IDEX Biometrics UK
+//
+// 17-10-26 -- Starting the implementation
+//================================================================
+#include <Arduino.h>
+#include "CmndProcess.h"                // Bridge_SerialPrint()
+#include "SerialOut.h"                  // numbers straight into the TX ring
+#include "Latency.h"
+
+latencyEntry_t latencyTable[LATENCY_NUM_OPCODES];   // count = 0 - nothing learned yet
+bool           latencyAdaptive = true;
+byte           latencyCommand  = 0;     // the last command frame
+unsigned long  latencyStart_us = 0;     // its end
+bool           latencyArmed    = false; // no wait since that frame
+
+//================================================================
+void Latency_Command(byte command, unsigned long frameEnd_us)
+{
+  latencyCommand  = command;
+  latencyStart_us = frameEnd_us;
+  latencyArmed    = true;
+}
+
+bool Latency_Armed(void)
+{
+  return latencyArmed;
+}
+
+void Latency_Disarm(void)
+{
+  latencyArmed = false;
+}
+
+//================================================================
+// Sleep 7/8 of the learned minimum, counted from the end of the command frame
+//================================================================
+void Latency_WaitExpected(void)
+{
+  const latencyEntry_t *entry = &latencyTable[latencyCommand];
+  if (!latencyAdaptive || (entry->count == 0)) {
+    return;                     // nothing learned - poll straight away
+  }
+  unsigned long expected_us = entry->min_us - (entry->min_us >> 3);
+  unsigned long elapsed_us  = micros() - latencyStart_us;
+  if (elapsed_us < expected_us) {
+    delayMicroseconds(expected_us - elapsed_us);
+  }
+}
+
+//================================================================
+void Latency_Done(unsigned long doneFrameEnd_us)
+{
+  if (!latencyArmed) {
+    return;
+  }
+  latencyArmed = false;
+
+  unsigned long sample_us = doneFrameEnd_us - latencyStart_us;
+  if (sample_us > 0xFFFF) {
+    sample_us = 0xFFFF;
+  }
+  latencyEntry_t *entry = &latencyTable[latencyCommand];
+  if (entry->count == 0) {      // the first sample sets all
+    entry->min_us = entry->avg_us = entry->max_us = sample_us;
+  }
+  else {
+    if (sample_us < entry->min_us) { entry->min_us = sample_us; }
+    if (sample_us > entry->max_us) { entry->max_us = sample_us; }
+    entry->avg_us += ((long)sample_us - (long)entry->avg_us) >> LATENCY_AVG_SHIFT;
+  }
+  if (entry->count < 0xFFFF) {
+    entry->count++;
+  }
+}
+
+//================================================================
+void Latency_Reset(void)
+{
+  memset(latencyTable, 0, sizeof(latencyTable));
+  latencyArmed = false;
+}
+
+//================================================================
+// <latency> - latency = on
+//               0x23 = 12/15/40 us, 57
+//================================================================
+void Latency_Report(void)
+{
+  Bridge_SerialPrint("latency = ");
+  Bridge_SerialPrintLn(latencyAdaptive ? "on" : "off");
+  for (int ii = 0; ii < LATENCY_NUM_OPCODES; ii++) {   // only the commands which were learned
+    const latencyEntry_t *entry = &latencyTable[ii];
+    if (entry->count != 0) {
+      Bridge_SerialPrint("  0x");
+      if (ii < 0x10) {
+        Out_Char('0');
+      }
+      Out_Hex(ii);
+      Bridge_SerialPrint(" = ");
+      Out_UInt(entry->min_us);
+      Out_Char('/');
+      Out_UInt(entry->avg_us);
+      Out_Char('/');
+      Out_UInt(entry->max_us);
+      Bridge_SerialPrint(" us, ");
+      Out_UInt(entry->count);
+      Bridge_SerialPrintLn();
+    }
+  }
+} // end of Latency_Report()
@@ -0,0 +1,43 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Learned DONE latency per command - <latency>
+// IDEX Biometrics UK
+//
+// The time from the end of the command frame to the status frame which saw DONE is kept
+// per command byte (min/avg/max). WaitForDoneAndGetStatus() sleeps 7/8 of the learned
+// minimum before the first status poll, then polls with a growing gap. Waiting less than
+// the minimum lets the minimum go down when the module gets faster.
+//
+// 17-10-26 -- Creating the file
+//
+//================================================================
+#ifndef _LATENCY_H
+#define _LATENCY_H
+
+#include <Arduino.h>      // when we use definitions like byte, etc. we need to include it
+
+#define LATENCY_NUM_OPCODES    256   // learned by the whole command byte (read mask included)
+#define LATENCY_AVG_SHIFT        3   // running average - new sample has weight 1/8
+#define DONE_POLL_BUDGET_US     82   // one unit of max_number_wait - the old loop took ~82us per poll (see WaitForDoneAndGetStatus)
+#define DONE_POLL_GAP_MIN_US    10   // the first gap between polls ...
+#define DONE_POLL_GAP_MAX_US    40   // ... doubles up to this
+
+typedef struct {
+  uint16_t min_us;
+  uint16_t avg_us;
+  uint16_t max_us;
+  uint16_t count;       // saturates at 0xFFFF
+} latencyEntry_t;
+
+extern bool latencyAdaptive;     // TRUE - pre-wait and backoff, FALSE - fixed 25us polling like before
+
+//--------- Function prototypes -----------------------------------------------------------
+void Latency_Command(byte command, unsigned long frameEnd_us);   // a command frame went out - the next wait belongs to it
+bool Latency_Armed(void);                       // there was a command frame since the last wait
+void Latency_WaitExpected(void);                // sleep the part of the latency which surely isn't done
+void Latency_Done(unsigned long doneFrameEnd_us);   // DONE seen - learn and disarm
+void Latency_Disarm(void);                      // timeout or a peek - nothing learned
+void Latency_Reset(void);
+void Latency_Report(void);                      // one line per learned command (without the delimiter)
+
+#endif  // end _LATENCY_H
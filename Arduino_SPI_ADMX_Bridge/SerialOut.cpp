@@ -0,0 +1,144 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Serial output through a TX ring buffer (no heap)
+// IDEX Biometrics UK
+//
+// 17-10-26 -- Creating the file
+//================================================================
+#include <Arduino.h>
+#include <stdio.h>          // snprintf() for the floats
+#include "SerialOut.h"
+#include "Stats.h"          // USB write counter
+
+char txRing[SIZE_TX_RING];      // output data waiting for USB
+unsigned int txHead  = 0;       // where the next char is stored
+unsigned int txTail  = 0;       // the oldest char not sent yet
+unsigned int txCount = 0;       // how many chars are waiting
+
+static_assert((SIZE_TX_RING & TX_RING_MASK) == 0, "SIZE_TX_RING must be power of 2");
+
+//================================================================
+// Hand over to USB one contiguous block (up to maxLen chars) - returns how many were sent
+//================================================================
+int Out_WriteChunk(unsigned int maxLen)
+{
+  unsigned int len = SIZE_TX_RING - txTail;   // till the end of the ring
+  if (len > txCount) {
+    len = txCount;
+  }
+  if (len > maxLen) {
+    len = maxLen;
+  }
+  if (len > 0) {
+    Serial.write((const uint8_t *)&txRing[txTail], len);   // one USB write for the whole block
+    Stats_UsbWrite(len);
+    txTail = (txTail + len) & TX_RING_MASK;
+    txCount -= len;
+  }
+  return len;
+}
+
+//================================================================
+void Out_Flush(void)
+{
+  while (txCount > 0) {
+    Out_WriteChunk(txCount);   // at most two writes - before and after the ring wraps
+  }
+}
+
+//================================================================
+void Out_Service(void)
+{
+  int room = Serial.availableForWrite();   // what USB takes without blocking
+  while ((room > 0) && (txCount > 0)) {
+    room -= Out_WriteChunk(room);
+  }
+}
+
+//================================================================
+int Out_Pending(void)
+{
+  return txCount;
+}
+
+//================================================================
+void Out_Char(char outChar)
+{
+  if (txCount >= SIZE_TX_RING) {
+    Out_Flush();   // ring full - make space
+  }
+  txRing[txHead] = outChar;
+  txHead = (txHead + 1) & TX_RING_MASK;
+  txCount++;
+}
+
+//================================================================
+void Out_Str(const char outStr[])
+{
+  while (*outStr != char(0)) {
+    Out_Char(*outStr++);
+  }
+}
+
+//================================================================
+void Out_Bytes(const byte outBytes[], int len)
+{
+  for (int ii = 0; ii < len; ii++) {
+    Out_Char((char)outBytes[ii]);
+  }
+}
+
+//================================================================
+// Numbers - digits are produced backwards into a small buffer on the stack
+//================================================================
+void Out_UInt(unsigned long val)
+{
+  char digits[10];   // 4294967295 is the longest
+  int  nDigits = 0;
+
+  do {
+    digits[nDigits++] = '0' + (val % 10);
+    val /= 10;
+  } while (val > 0);
+
+  while (nDigits > 0) {
+    Out_Char(digits[--nDigits]);
+  }
+}
+
+//================================================================
+void Out_Int(long val)
+{
+  if (val < 0) {
+    Out_Char('-');
+    Out_UInt(0UL - (unsigned long)val);   // works for the most negative value too
+  }
+  else {
+    Out_UInt((unsigned long)val);
+  }
+}
+
+//================================================================
+void Out_Hex(unsigned long val)
+{
+  const char hexDigits[] = "0123456789abcdef";
+  char digits[8];
+  int  nDigits = 0;
+
+  do {
+    digits[nDigits++] = hexDigits[val & 0x0F];
+    val >>= 4;
+  } while (val > 0);
+
+  while (nDigits > 0) {
+    Out_Char(digits[--nDigits]);
+  }
+}
+
+//================================================================
+void Out_Float(double val, int decimals)
+{
+  char floatBuffer[OUT_FLOAT_BUF_LEN];   // on the stack - no String
+  snprintf(floatBuffer, sizeof(floatBuffer), "%.*f", decimals, val);
+  Out_Str(floatBuffer);
+}
@@ -0,0 +1,35 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Serial output through a TX ring buffer (no heap)
+// IDEX Biometrics UK
+//
+// Strings, numbers and binary records are appended to txRing[] and go to USB
+// in large writes: at the end of each response (delimiter), at the end of a
+// FIFO drain pass and from loop() as much as the USB buffer can take.
+// When the ring is full it's written out before appending more.
+//
+// 17-10-26 -- Creating the file
+//
+//================================================================
+#ifndef _SERIAL_OUT_H
+#define _SERIAL_OUT_H
+
+#include <Arduino.h>     // when we use definitions like byte, etc. we need to include it
+
+#define SIZE_TX_RING      1024   // must be power of 2 - a full Z run batch of ascii records is ~30 bytes each
+#define TX_RING_MASK      (SIZE_TX_RING - 1)
+#define OUT_FLOAT_BUF_LEN   48   // longest %.Nf we print (float max is 39 digits + sign + decimals)
+
+//--------- Function prototypes -----------------------------------------------------------
+void Out_Char(char outChar);                          // one character
+void Out_Str(const char outStr[]);                    // zero terminated string
+void Out_Bytes(const byte outBytes[], int len);       // binary data
+void Out_UInt(unsigned long val);                     // decimal like String(val)
+void Out_Int(long val);                               // decimal with sign
+void Out_Hex(unsigned long val);                      // lower case hex without leading zeros like String(val, HEX)
+void Out_Float(double val, int decimals);             // fixed point like String(val, decimals)
+void Out_Flush(void);                                 // write everything to USB (blocks till the data is handed over)
+void Out_Service(void);                               // write what the USB buffer can take without blocking - called from loop()
+int  Out_Pending(void);                               // bytes waiting in the ring
+
+#endif // end _SERIAL_OUT_H
@@ -0,0 +1,133 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Shadow copy of the ADMX parameters
+// IDEX Biometrics UK
+//
+// 17-10-26 -- Starting the implementation
+//================================================================
+#include <Arduino.h>
+#include "SPI_cmnd.h"        // SPI commands definitions
+#include "CmndProcess.h"     // SingleParamReadWrite_waitDone()
+#include "SlowTask.h"        // flag_ERROR
+#include "ShadowCache.h"
+
+bool     shadowEnabled = true;               // reads are answered from the copy
+uint32_t shadowVal[SHADOW_SIZE];             // last value written or read
+uint32_t shadowValid[SHADOW_SIZE / 32];      // one bit per parameter - TRUE if shadowVal is valid
+
+//================================================================
+// Parameters which the module changes without us writing them are not kept
+//================================================================
+bool Shadow_IsCacheable(byte command)
+{
+  byte opcode = command & ~CMND_READ_MASK;
+
+  if (opcode < CMD_FREQUENCY) {        // commands (temperature, cal read...) - not parameters
+    return false;
+  }
+
+  switch (opcode) {
+    case CMD_SET_GPIO:                 // pins can be inputs
+    case CMD_ACTUAL_COUNT:             // changes during the measurement
+      return false;
+
+    case CMD_VOLTAGE_GAIN:             // with autorange the module sets the gains itself
+    case CMD_CURRENT_GAIN: {
+      uint32_t autorange;
+      return Shadow_Get(CMD_ENABLE_AUTORANGE, &autorange) && (autorange == 0);
+    }
+    default:
+      return true;
+  }
+} // end of Shadow_IsCacheable
+
+//================================================================
+void Shadow_Store(byte command, uint32_t value)
+{
+  byte opcode = command & ~CMND_READ_MASK;
+
+  if (opcode == CMD_ENABLE_AUTORANGE) {   // gains are valid only while autorange is off
+    Shadow_Invalidate(CMD_VOLTAGE_GAIN);
+    Shadow_Invalidate(CMD_CURRENT_GAIN);
+  }
+
+  shadowVal[opcode] = value;
+  shadowValid[opcode / 32] |= (1UL << (opcode % 32));
+}
+
+//================================================================
+bool Shadow_Get(byte command, uint32_t *value)
+{
+  byte opcode = command & ~CMND_READ_MASK;
+
+  if (!(shadowValid[opcode / 32] & (1UL << (opcode % 32)))) {
+    return false;   // never written or invalidated
+  }
+  *value = shadowVal[opcode];
+  return true;
+}
+
+//================================================================
+bool Shadow_ReadAllowed(byte command, uint32_t *value)
+{
+  return shadowEnabled && Shadow_IsCacheable(command) && Shadow_Get(command, value);
+}
+
+//================================================================
+void Shadow_Invalidate(byte command)
+{
+  byte opcode = command & ~CMND_READ_MASK;
+  shadowValid[opcode / 32] &= ~(1UL << (opcode % 32));
+}
+
+//================================================================
+void Shadow_InvalidateAll(void)
+{
+  for (int ii = 0; ii < SHADOW_SIZE / 32; ii++) {
+    shadowValid[ii] = 0;
+  }
+}
+
+//================================================================
+int Shadow_ValidCount(void)
+{
+  int validCount = 0;
+  for (int ii = 0; ii < SHADOW_SIZE; ii++) {
+    if (shadowValid[ii / 32] & (1UL << (ii % 32))) {
+      validCount++;
+    }
+  }
+  return validCount;
+}
+
+//================================================================
+// The module accepted (or refused/changed) a value we wrote
+//================================================================
+void Shadow_NoteWrite(byte command, uint32_t value)
+{
+  if (flag_ERROR || flag_WARNING || !Shadow_IsCacheable(command)) {
+    Shadow_Invalidate(command);   // refused, limited (like magnitude > 1V) or volatile - read it back next time
+  }
+  else {
+    Shadow_Store(command, value);
+  }
+} // end of Shadow_NoteWrite
+
+//================================================================
+// Read a parameter - from the copy when we can, otherwise from the module (and keep it)
+// errors of the module read are reported with custMessage (if not NULL)
+//================================================================
+bool Shadow_ReadParam(byte command, uint32_t *value, bool forceHw, const char custMessage[])
+{
+  if (!forceHw && Shadow_ReadAllowed(command, value)) {
+    return true;    // no SPI traffic
+  }
+
+  *value = SingleParamReadWrite_waitDone(command | CMND_READ_MASK, 0, 0, READ_MODE);  // read parameter
+  bool readOK = (custMessage != NULL) ? IsOK_Report_Err_Warn(custMessage, command | CMND_READ_MASK) : !flag_ERROR;
+
+  if (readOK && Shadow_IsCacheable(command)) {
+    Shadow_Store(command, *value);
+  }
+  return readOK;
+} // end of Shadow_ReadParam
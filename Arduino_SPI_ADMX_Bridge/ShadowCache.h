@@ -0,0 +1,34 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Shadow copy of the ADMX parameters (frequency, magnitude, count...)
+// IDEX Biometrics UK
+//
+// Every parameter the bridge writes or reads is kept here, so the next read can be
+// answered without SPI traffic. The copy is invalidated on <reset>, bridge reset,
+// <setgain auto> and <calibrate reload>. Values the module changes by itself
+// (temperature, gains with autorange, GPIO, actual count) are never kept.
+//
+// 17-10-26 -- Creating the file
+//
+//================================================================
+#ifndef _SHADOW_CACHE_H
+#define _SHADOW_CACHE_H
+
+#include <Arduino.h>     // when we use definitions like byte, etc. we need to include it
+
+#define SHADOW_SIZE      128    // parameters are addressed by the opcode without the read mask (0x00..0x7F)
+
+//--------- Function prototypes -----------------------------------------------------------
+void     Shadow_Store(byte command, uint32_t value);         // keep the value the module accepted
+bool     Shadow_Get(byte command, uint32_t *value);          // TRUE if we have a valid copy (regardless of the shadow mode)
+bool     Shadow_ReadAllowed(byte command, uint32_t *value);  // TRUE if the read can be answered from the copy (shadow mode on)
+void     Shadow_Invalidate(byte command);                    // forget one parameter
+void     Shadow_InvalidateAll(void);                         // forget everything
+int      Shadow_ValidCount(void);                            // how many parameters are kept
+void     Shadow_NoteWrite(byte command, uint32_t value);     // after a write - keep the value, or forget it if the module reported error/warning
+bool     Shadow_ReadParam(byte command, uint32_t *value, bool forceHw, const char custMessage[]);  // from the copy or from the module, FALSE on error
+
+//--------- External variables -----------------------------------------------------------
+extern bool shadowEnabled;      // TRUE - reads are answered from the copy
+
+#endif // end _SHADOW_CACHE_H
@@ -8,56 +8,375 @@
 // 07-08-24 -- Starting the project, testing the serial, setting DTR to receive data
 //
 //================================================================
+#include <math.h>                       // sqrt() for the run statistics
 #include "SlowTask.h"                   // inlcude Slow task header
 #include "CmndProcess.h"                // inlcude functionality from command processor
 #include "SPI_cmnd.h"                   // SPI commands definitions
 #include "LIF.h"                        // inlcude debugger
+#include "SpiQueue.h"                   // FIFO reads are queued during the drain
+#include "ShadowCache.h"                // known parameters without SPI reads
+#include "SerialOut.h"                  // records are collected in the TX ring
+#include "FastFormat.h"                 // fast "%.7e" for the results
+#include "Sweep.h"                      // sweep records carry the point frequency
+#include "Stats.h"                      // drained records are counted
+#include "CalSupport.h"                 // calibration index is cleared by the erase
+
+//-------- Status polls are scheduled from what is running (deadline in nextPoll_us)
+#define DONE_POLLING_TIME_MS    5       // polling period for calibrate/commit/erase/reload, 5..20ms is a good balance between performace and responsivness 
+#define MIN_POLL_INTERVAL_US    250     // during Z never poll the status more often than this
+#define MAX_POLL_INTERVAL_US  20000     // and never less often - errors and warnings must still be reported
+#define POLL_BATCH_RECORDS       16     // on long runs wait for this many records before polling (1/16 of the FIFO)
+#define CYCLES_PER_AVERAGE        4     // seed of the sample time - signal periods per averaged measurement
+#define MIN_MEASURE_TIME_US     250     // seed of the sample time - processing floor of one measurement
+
+unsigned long nextPoll_us = 0;          // when the slow task runs next time (compared as signed difference - safe on rollover)
+unsigned long runStart_us = 0;          // when the current Z run was started - used for the observed fill rate
+unsigned long drainBudget_us = DEFAULT_DRAIN_BUDGET_US;  // max time for one FIFO drain pass, 0 - one record per tick (old behaviour)
+zFormat_t zOutFormat = ZFMT_ASCII;      // Z records are text by default
+bool zStampEnabled = false;             // TRUE - records carry sequence number, drain time and records pending
+uint32_t zSequence = 0;                 // record sequence number, survives <z> commands
+bool fifoBacklog = false;               // TRUE if the last drain pass ran out of time and left complete records in the FIFO
+zStats_t zStatsMode = ZSTATS_OFF;       // no statistics by default - every record goes out
+
+//-------- Run statistics (Welford) - one pass, no record is kept, stable also for large offsets with small noise
+struct runStat_t {
+  double_t mean;                        // running mean
+  double_t m2;                          // sum of squared differences from the mean
+  double_t minVal;                      // smallest value of the run
+  double_t maxVal;                      // biggest value of the run
+  uint32_t n;                           // values in the statistics
+};
+byte   zDerivedList[ZDERIVED_MAX];      // derived quantities in the output order
+int    zDerivedCount = 0;               // 0 - the records carry the raw Rm/Xm
+float  zDerivedFreqHz = 0;              // measurement frequency of the run (shadow copy), a module sweep takes it per record
+runStat_t zStatsR, zStatsX;             // Rm and Xm
 
-#define DONE_POLLING_TIME_MS    5       // prevents to often calling of the task, 5..20ms is a good balance between performace and responsivness 
-unsigned long lastPollTime = millis();  // here we keep track of the last moment we polled the status and if it exceeds the limit - poll it again 
+//================================================================
+// Add one value to the statistics
+//================================================================
+static void RunStat_Add(runStat_t &st, double_t val)
+{
+  st.n++;
+  if (st.n == 1) {                      // first value of the run
+    st.mean = val;
+    st.m2 = 0;
+    st.minVal = val;
+    st.maxVal = val;
+    return;
+  }
+  double_t delta = val - st.mean;
+  st.mean += delta / st.n;
+  st.m2 += delta * (val - st.mean);     // old and new mean - no cancellation
+  if (val < st.minVal) {
+    st.minVal = val;
+  }
+  if (val > st.maxVal) {
+    st.maxVal = val;
+  }
+} // end of RunStat_Add
 
 //================================================================
-// Extract one record from FIFO and report it over serial
+// Sample standard deviation (N-1), 0 for less than two values
+//================================================================
+static double_t RunStat_Std(const runStat_t &st)
+{
+  if (st.n < 2) {
+    return 0;
+  }
+  return sqrt(st.m2 / (st.n - 1));
+} // end of RunStat_Std
+
+//================================================================
+// Clear the statistics - every <z> run and every sweep point
+//================================================================
+void ZStats_Start(void)
+{
+  memset(&zStatsR, 0, sizeof(zStatsR));   // n = 0
+  memset(&zStatsX, 0, sizeof(zStatsX));
+} // end of ZStats_Start
+
+//================================================================
+// Output the statistics of the run - <zstats = N,Rmean,Rstd,Rmin,Rmax,Xmean,Xstd,Xmin,Xmax> or binary record
+//================================================================
+void ZStats_Report(void)
+{
+  double_t vals[8] = {zStatsR.mean, RunStat_Std(zStatsR), zStatsR.minVal, zStatsR.maxVal,
+                      zStatsX.mean, RunStat_Std(zStatsX), zStatsX.minVal, zStatsX.maxVal};
+
+  if (zOutFormat == ZFMT_BINARY) {
+    byte payload[BIN_ZSTATS_PAYLOAD_LEN];
+    memcpy(&payload[0], &zStatsR.n, 4);   // Rm and Xm have the same N
+    memcpy(&payload[4], vals, sizeof(vals));
+    Bridge_SerialWriteRecord(BIN_TYPE_ZSTATS, payload, BIN_ZSTATS_PAYLOAD_LEN);
+  }
+  else {
+    char floatBuffer[SIZE_SUB_ARRAY];
+    Bridge_SerialPrint("zstats = ");
+    Out_UInt(zStatsR.n);
+    for (int ii = 0; ii < 8; ii++) {
+      Bridge_SerialPrint(",");
+      FormatSci7(vals[ii], floatBuffer);
+      Bridge_SerialPrint(floatBuffer);
+    }
+    Bridge_SerialPrintLn();
+  }
+} // end of ZStats_Report
+
+//================================================================
+// Take the measurement frequency before the run - the drain can't read parameters
+//================================================================
+void ZDerived_Start(void)
+{
+  uint32_t rawFreq;
+  if (zDerivedCount == 0) {          // raw records - nothing to compute
+    return;
+  }
+  if (Shadow_ReadParam(CMD_FREQUENCY, &rawFreq, false, NULL)) {  // normally from the copy, no SPI
+    zDerivedFreqHz = ConvInt32ToFloat(rawFreq);
+  }
+  else {
+    zDerivedFreqHz = 0;               // unknown - C and L come out as inf
+  }
+} // end of ZDerived_Start
+
+//================================================================
+// One derived quantity from Rm/Xm, omega = 2*pi*f (series and parallel models)
+//================================================================
+static double_t ZDerived_Value(byte quantity, double_t Rm, double_t Xm, double_t omega)
+{
+  double_t z2 = Rm * Rm + Xm * Xm;    // |Z|^2
+  switch (quantity) {
+    case ZD_Z:     return sqrt(z2);
+    case ZD_PHASE: return atan2(Xm, Rm) * (180.0 / M_PI);  // degrees
+    case ZD_RS:    return Rm;
+    case ZD_XS:    return Xm;
+    case ZD_CS:    return -1.0 / (omega * Xm);
+    case ZD_CP:    return -Xm / (omega * z2);
+    case ZD_LS:    return Xm / omega;
+    case ZD_LP:    return z2 / (omega * Xm);
+    case ZD_RP:    return z2 / Rm;
+    case ZD_D:     return Rm / fabs(Xm);
+    case ZD_Q:     return fabs(Xm) / Rm;
+    default:       return 0;
+  }
+} // end of ZDerived_Value
+
+//================================================================
+// Report one Z record as the selected derived quantities - <counter,freq,v1,v2...> or binary record
+//================================================================
+static void ReportZ_Derived(double_t Rm, double_t Xm, int recordsPending, uint32_t stampTime_us)
+{
+  double_t vals[ZDERIVED_MAX];
+  float freqHz = Sweep_Active() ? Sweep_RecordFreq() : zDerivedFreqHz;  // a module sweep changes it every record
+  int counter = Sweep_Active() ? Sweep_RecordIndex() : measureZ_counter;
+  double_t omega = 2.0 * M_PI * freqHz;
+
+  for (int ii = 0; ii < zDerivedCount; ii++) {
+    vals[ii] = ZDerived_Value(zDerivedList[ii], Rm, Xm, omega);
+  }
+
+  if (zOutFormat == ZFMT_BINARY) {
+    byte payload[BIN_ZD_HEADER_LEN + ZDERIVED_MAX * 8 + BIN_STAMP_LEN];
+    uint32_t counter32 = (uint32_t)counter;
+    byte payloadLen = BIN_ZD_HEADER_LEN + zDerivedCount * 8;
+    memcpy(&payload[0], &counter32, 4);
+    memcpy(&payload[4], &freqHz, 4);
+    memcpy(&payload[BIN_ZD_HEADER_LEN], vals, zDerivedCount * 8);
+    if (zStampEnabled) {              // same tail as the raw records
+      uint16_t pending16 = (uint16_t)recordsPending;
+      memcpy(&payload[payloadLen], &zSequence, 4);
+      memcpy(&payload[payloadLen + 4], &stampTime_us, 4);
+      memcpy(&payload[payloadLen + 8], &pending16, 2);
+      payloadLen += BIN_STAMP_LEN;
+    }
+    Bridge_SerialWriteRecord(BIN_TYPE_ZD, payload, payloadLen);
+    return;
+  }
+
+  char floatBuffer[SIZE_SUB_ARRAY];
+  Out_Int(counter);
+  Bridge_SerialPrint(",");
+  FormatSci7(freqHz, floatBuffer);
+  Bridge_SerialPrint(floatBuffer);    // the frequency the values were computed with
+  for (int ii = 0; ii < zDerivedCount; ii++) {
+    Bridge_SerialPrint(",");
+    FormatSci7(vals[ii], floatBuffer);
+    Bridge_SerialPrint(floatBuffer);
+  }
+  if (zStampEnabled) {                // <...,seq,time_us,pending>
+    Bridge_SerialPrint(",");
+    Out_UInt(zSequence);
+    Bridge_SerialPrint(",");
+    Out_UInt(stampTime_us);
+    Bridge_SerialPrint(",");
+    Out_Int(recordsPending);
+  }
+  Bridge_SerialPrintLn();
+} // end of ReportZ_Derived
+
+//================================================================
+// Report one Z record (four FIFO words) over serial
 //================================================================
-void ReportZ_fromFIFO(void)
+void ReportZ_Record(const uint32_t resultFIFO[4], int recordsPending)
 {
-uint32_t resultFIFO_0, resultFIFO_1;  // we accumulate the reading here
 uint64_t mergedVal64;                 // here we collect the data for conversion U64->double
 double_t Rm, Xm;                      // this is the measured impedance
 char floatBuffer[SIZE_SUB_ARRAY]; // here we store the float shar
+uint32_t stampTime_us = micros();     // when the record came out of the FIFO
+bool withStats = (zStatsMode != ZSTATS_OFF) && (stateMeasureZ == ACTIVE_Z);  // calibration points always go out
+bool derived = (zDerivedCount > 0) && (stateMeasureZ == ACTIVE_Z);           // calibration points stay Rm/Xm
+
+  if (withStats || derived) {        // decode here - the binary records don't need the doubles
+    mergedVal64 = (uint64_t)(resultFIFO[1])<<32 | resultFIFO[0];
+    Rm = ConvInt64ToDouble( mergedVal64);
+    mergedVal64 = (uint64_t)(resultFIFO[3])<<32 | resultFIFO[2];
+    Xm = ConvInt64ToDouble( mergedVal64);
+  }
+  if (withStats) {                   // statistics are always over Rm/Xm
+    RunStat_Add(zStatsR, Rm);
+    RunStat_Add(zStatsX, Xm);
+  }
+
+  if (!withStats || (zStatsMode != ZSTATS_ONLY)) {   // with <zstats only> the record is just counted, nothing goes to USB
+    if (derived) {
+      ReportZ_Derived(Rm, Xm, recordsPending, stampTime_us);
+    }
+    else if (zOutFormat == ZFMT_BINARY) {   // binary record - the FIFO words are the two doubles already
+      byte payload[BIN_ZF_PAYLOAD_LEN + BIN_STAMP_LEN];
+      byte recType = BIN_TYPE_Z;
+      byte payloadLen = BIN_Z_PAYLOAD_LEN;
+      uint32_t counter32 = (uint32_t)measureZ_counter;   // no wrap within a run (count is 32 bit)
+      if (Sweep_Active()) {            // sweep - the point frequency between counter and Rm/Xm
+        float freqHz = Sweep_RecordFreq();
+        counter32 = (uint32_t)Sweep_RecordIndex();
+        memcpy(&payload[4], &freqHz, 4);
+        memcpy(&payload[8], resultFIFO, 16);
+        recType = BIN_TYPE_ZF;
+        payloadLen = BIN_ZF_PAYLOAD_LEN;
+      }
+      else {
+        memcpy(&payload[4], resultFIFO, 16);
+      }
+      memcpy(&payload[0], &counter32, 4);
+      if (zStampEnabled) {             // seq, time and pending at the end - the host tells them by the length
+        uint16_t pending16 = (uint16_t)recordsPending;
+        memcpy(&payload[payloadLen], &zSequence, 4);
+        memcpy(&payload[payloadLen + 4], &stampTime_us, 4);
+        memcpy(&payload[payloadLen + 8], &pending16, 2);
+        payloadLen += BIN_STAMP_LEN;
+      }
+      Bridge_SerialWriteRecord(recType, payload, payloadLen);
+    }
+    else {
+      mergedVal64 = (uint64_t)(resultFIFO[1])<<32 | resultFIFO[0];  // merge the two U32 words into U64
+      Rm = ConvInt64ToDouble( mergedVal64);    // this is the first result as double
+      mergedVal64 = (uint64_t)(resultFIFO[3])<<32 | resultFIFO[2];  // merge the two U32 words into U64
+      Xm = ConvInt64ToDouble( mergedVal64);    // this is the Second result as double
+
+      if (Sweep_Active()) {             // <counter,freq,Rm,Xm>
+        Out_Int(Sweep_RecordIndex());
+        Bridge_SerialPrint(","); // delimiter
+        FormatSci7(Sweep_RecordFreq(), floatBuffer);
+        Bridge_SerialPrint(floatBuffer);  // point frequency in Hz
+      }
+      else {
+        Out_Int(measureZ_counter);
+      }
+      Bridge_SerialPrint(","); // delimiter
+
+      FormatSci7(Rm, floatBuffer);      // same text as "%.7e", without the printf engine
+      Bridge_SerialPrint(floatBuffer);  // Output real
+
+      Bridge_SerialPrint(","); // delimiter
+
+      FormatSci7(Xm, floatBuffer);      // same text as "%.7e", without the printf engine
+      Bridge_SerialPrint(floatBuffer);  // Output real
+
+      if (zStampEnabled) {              // <...,seq,time_us,pending>
+        Bridge_SerialPrint(",");
+        Out_UInt(zSequence);
+        Bridge_SerialPrint(",");
+        Out_UInt(stampTime_us);
+        Bridge_SerialPrint(",");
+        Out_Int(recordsPending);
+      }
+      Bridge_SerialPrintLn();
+    }
+  }
+
+  measureZ_counter++;  // ready for the next sample
+  zSequence++;         // counts all records since power up, <z> doesn't reset it
 
-        //--------- Pull one Z record from the FIFO (four 32bit words)                          
-  resultFIFO_0 = Single_ADMX_Frame(CMD_FIFO_READ, 0, 0);  // read the data, before resultFIFO_0 = Single_ADMX_Frame(CMD_FIFO_READ, 0, 0);
-  resultFIFO_1 = Single_ADMX_Frame(CMD_FIFO_READ, 0, 0);  // read the data
-  mergedVal64 = (uint64_t)(resultFIFO_1)<<32 | resultFIFO_0;  // merge the two U32 words into U64
-  Rm = ConvInt64ToDouble( mergedVal64);    // this is the first result as double
+} // end of ReportZ_Record
+
+//================================================================
+// FIFO words come back through the SPI queue - store them into the record slot
+//================================================================
+#define DRAIN_RECORD_SLOTS   (SIZE_SPI_QUEUE / 4)   // records which can be in flight in the SPI queue
+uint32_t drainWords[DRAIN_RECORD_SLOTS][4];        // FIFO words of the records in flight
+int drainWordsDone = 0;                            // words received in the current drain pass
 
-  Bridge_SerialPrint(String(measureZ_counter));
-  Bridge_SerialPrint(","); // delimiter
+void StoreDrainWord(uint32_t dataIn, void *context)
+{
+  *(uint32_t *)context = dataIn;   // context is the place of the word in drainWords
+  drainWordsDone++;
+}
 
-  sprintf(floatBuffer, "%.7e", Rm); // here we store the float shar
-  Bridge_SerialPrint(floatBuffer);  // Output real
+//================================================================
+// Pull all complete Z records (depthFIFO/4) out of the FIFO in one pass
+// the pass is limited by drainBudget_us, so the USB receive loop is not starved on long runs
+// FIFO reads go through the SPI queue - while the gap before the next frame runs we report
+// the record which is already complete
+//================================================================
+int DrainZ_fromFIFO(void)
+{
+  int recordsFIFO = depthFIFO / 4;      // each record is 4 words (Rm LSB/MSB, Xm LSB/MSB)
+  int queued  = 0;                      // records with FIFO reads in the SPI queue
+  int drained = 0;                      // how many records we reported in this pass
+  unsigned long startDrain = micros();  // the budget is counted from here
 
-  Bridge_SerialPrint(","); // delimiter
+  if (drainBudget_us == 0) {            // drain disabled - keep the old one record per tick
+    recordsFIFO = min(recordsFIFO, 1);
+  }
 
-  resultFIFO_0 = Single_ADMX_Frame(CMD_FIFO_READ, 0, 0);  // read the data, before: resultFIFO_0 = Single_ADMX_Frame(CMD_FIFO_READ, 0, 0);
-  resultFIFO_1 = Single_ADMX_Frame(CMD_FIFO_READ, 0, 0);  // read the data
-  mergedVal64 = (uint64_t)(resultFIFO_1)<<32 | resultFIFO_0;  // merge the two U32 words into U64
-  Xm = ConvInt64ToDouble( mergedVal64);    // this is the Second result as double
+  drainWordsDone = 0;
+  while (drained < recordsFIFO) {
 
-  sprintf(floatBuffer, "%.7e", Xm); // here we store the float shar
-  Bridge_SerialPrintLn(floatBuffer);  // Output real
+    while ((queued < recordsFIFO) && (SpiQueue_Free() >= 4)) {   // keep the queue full with the next records
+      for (int ii = 0; ii < 4; ii++) {
+        SpiQueue_Enqueue(CMD_FIFO_READ, 0, 0, StoreDrainWord, &drainWords[queued % DRAIN_RECORD_SLOTS][ii]);
+      }
+      queued++;
+    }
 
-  measureZ_counter++;  // ready for the next sample
+    SpiQueue_Service();                 // next FIFO read if the gap allows it
 
-} // end of eportZ_fromFIFO
+    if (drainWordsDone >= (drained + 1) * 4) {   // the oldest record in flight is complete
+      // records pending incl. this one - counted from the status read at the start of the pass, the FIFO
+      // reads carry no status, so it is an estimate: the module may have added records since (never fewer)
+      ReportZ_Record(drainWords[drained % DRAIN_RECORD_SLOTS], depthFIFO / 4 - drained);
+      drained++;
+
+      if ((micros() - startDrain) >= drainBudget_us) {  // unsigned difference is safe on micros() rollover
+        recordsFIFO = queued;           // out of time - finish the records in flight, the rest will be pulled on the next pass
+      }
+    }
+  }
+
+  fifoBacklog = (depthFIFO / 4 > drained) && (drainBudget_us != 0);  // records left - don't wait for the next tick
+  Out_Flush();                          // all records of the pass in one USB write
+  Stats_Records(drained);
+  depthFIFO  -= drained * 4;            // keep the status copy in step with what we pulled out
+
+  return drained;
+} // end of DrainZ_fromFIFO
 
 //================================================================
 // Extract one record from FIFO and report it over serial
 //================================================================
 void Flush_FIFO(void) // flush all data from FIFO  
 {
-  for (int ii = 0; ii < 256; ii++)  // avoid hanging here - limit the max number of fifo records to 256 (if by some reason we get huge number)
+  for (int ii = 0; ii <= (int)(ADMX200X_STATUS_FIFO_DEPTH_BITM >> 16); ii++)  // avoid hanging here - at most the 10 bit FIFO depth (1023 words) + the last status
   {
     WaitForDoneAndGetStatus(1);  // update the status of depthFIFO
 
@@ -70,31 +389,82 @@ void Flush_FIFO(void) // flush all data from FIFO
 
 } // end of FLUSH_FIFO
 
+//================================================================
+// Expected time between Z records in us
+// first from the parameters (seed), then from the records we already got (observed fill rate)
+//================================================================
+unsigned long SampleTimeEstimate_us(void)
+{
+  if (measureZ_counter > 0) {   // observed - includes mdelay and everything the module does per sample
+    return (micros() - runStart_us) / measureZ_counter;
+  }
+
+  uint32_t rawFreq, rawMdelay, average;   // the parameters as the shadow copy keeps them (frequency/mdelay are float)
+  if (!Shadow_Get(CMD_FREQUENCY, &rawFreq) || !Shadow_Get(CMD_AVERAGE, &average) || (average == 0)) {
+    return DONE_POLLING_TIME_MS * 1000UL;   // nothing known - behave as the fixed tick
+  }
+  if (!Shadow_Get(CMD_MDELAY, &rawMdelay)) {
+    rawMdelay = 0;                          // float 0.0
+  }
+
+  float freq_Hz = ConvInt32ToFloat(rawFreq);
+  float perAverage_us = (freq_Hz > 0) ? CYCLES_PER_AVERAGE * 1e6 / freq_Hz : MIN_MEASURE_TIME_US;
+  if (perAverage_us < MIN_MEASURE_TIME_US) {
+    perAverage_us = MIN_MEASURE_TIME_US;
+  }
+  return (unsigned long)(ConvInt32ToFloat(rawMdelay) * 1000 + average * perAverage_us);
+} // end of SampleTimeEstimate_us
+
+//================================================================
+// How long to wait before the next status poll
+//================================================================
+unsigned long NextPollInterval_us(void)
+{
+  if (stateMeasureZ != ACTIVE_Z) {   // calibration and FLASH operations - fixed period
+    return DONE_POLLING_TIME_MS * 1000UL;
+  }
+
+  long remaining = 1;                // count not known - poll for every sample
+  uint32_t measCount;
+  if (Shadow_Get(CMD_COUNT, &measCount) && (measCount > 0)) {
+    remaining = (long)measCount - measureZ_counter;
+  }
+  if (remaining <= 0) {              // all records are out - only DONE is missing
+    return MIN_POLL_INTERVAL_US;
+  }
+  if (remaining > POLL_BATCH_RECORDS) {
+    remaining = POLL_BATCH_RECORDS;  // long run - drain in batches
+  }
+
+  unsigned long interval = SampleTimeEstimate_us() * remaining;
+  if (interval < MIN_POLL_INTERVAL_US) { interval = MIN_POLL_INTERVAL_US; }
+  if (interval > MAX_POLL_INTERVAL_US) { interval = MAX_POLL_INTERVAL_US; }
+  return interval;
+} // end of NextPollInterval_us
+
+//================================================================
+// Z run started - first poll when the first sample is expected
+//================================================================
+void Scheduler_StartRun(void)
+{
+  runStart_us = micros();
+  nextPoll_us = runStart_us + NextPollInterval_us();
+}
+
 //================================================================
 // Main processing of commands - we send SPI commands according to the ANSI commands strings in sub0..sub5
 //================================================================
 void ExecuteSlowTask(void)   // here we execute commands on regular intervals like wait for DONE and wait for MEASURE_DONE
 {
 
-unsigned long elapsedTimeMS;  // here we calculate the difference
 char reportStr[SIZE_SUB_ARRAY] = "";
 
 double floatResult;    // other floating temp 
 
-unsigned long currMillisecond = millis();
-
-  if (currMillisecond >= lastPollTime) { // normal operation - timer has no rollower 
-    elapsedTimeMS = currMillisecond - lastPollTime;  // calc elapsed time in ms
-  }
-  else {  // we hit rollover - it happens rarely, after 50 days and is recognizable because lastPollTime becomes greater than millis()
-    elapsedTimeMS = (LARGEST_UNIGNED_LONG - lastPollTime) + currMillisecond; // compensation of the elapsed time
-  }
-  
-  if (elapsedTimeMS >= DONE_POLLING_TIME_MS) // time to make new polling for DONE?
+  if (((long)(micros() - nextPoll_us) >= 0) || fifoBacklog) // time to make new polling for DONE? (or FIFO still has complete records)
   {
-    lastPollTime = currMillisecond;   // start new measurement 
 
-//---------------- HERE WE PASS EACH 5 ms -------------------------------------------------
+//---------------- HERE WE PASS WHEN THE NEXT POLL IS DUE ---------------------------------
 //=========================================================================================
 
     if (stateMeasureZ == ACTIVE_Z) {  // there is ACTIVE_Z measurement tak running, let's do some work
@@ -108,8 +478,8 @@ unsigned long currMillisecond = millis();
       {
         if (depthFIFO >= 4) // there is data to poll out and it has 4*N pending values we can take in one shot
         {
-          ReportZ_fromFIFO();  // reports real/imaginary and count
-        } // we had at least 4 records and we polled one data 
+          DrainZ_fromFIFO();  // reports real/imaginary and count for all complete records
+        } // we had at least 4 records and we polled them out
         // Flush_FIFO(); // flush all data from FIFO  
 
       }   // the current depth is > 0 
@@ -118,8 +488,13 @@ unsigned long currMillisecond = millis();
       else if (flag_DONE) { // it's ACTIVE_Z, no Z pending commands and MEASURE DONE  - move the state to IDLE and release the task for new processing
                             // flag_MEASURE_DONE should not be checked here, as this may result in skipping the error/warning messages
  
-        stateMeasureZ   = IDLE;    // set the measuring state to IDLE
-        Bridge_SerialPrintDelimiter() ;  // at the end of the task we pint a delimiter to extract the data from the PC FIFO
+        if (zStatsMode != ZSTATS_OFF) {
+          ZStats_Report();           // the summary of the run (of this sweep point)
+        }
+        if (!Sweep_NextPoint()) {  // a list sweep goes on with its next point, without the host
+          stateMeasureZ   = IDLE;    // set the measuring state to IDLE
+          Bridge_SerialPrintDelimiter() ;  // at the end of the task we pint a delimiter to extract the data from the PC FIFO
+        }
       } // we just hit the end of the ACTIVE_Z task! Status forced to IDLE
 
     }  // was active ACTIVE_Z measuring task
@@ -136,8 +511,8 @@ unsigned long currMillisecond = millis();
       {
         if (depthFIFO >= 4) // there is data to poll out and it has 4*N pending values we can take in one shot
         {
-          ReportZ_fromFIFO();  // reports real/imaginary and count
-        } // we had at least 4 records and we polled one data 
+          DrainZ_fromFIFO();  // reports real/imaginary and count for all complete records
+        } // we had at least 4 records and we polled them out
         
       }   // the current depth is > 0  - prefent the task from checking DONE - justr poll the data out
       else if (flag_DONE)      // it's ACTIVE_CAL and we just got DONE flag to move to next stage
@@ -145,12 +520,12 @@ unsigned long currMillisecond = millis();
         // report from CAL command (as in ANSI terminal interface)
 
         //---- FREQUENCY report
-        uint32_t resultTemp = SingleParamReadWrite_waitDone(CMD_FREQUENCY | CMND_READ_MASK, 0, 0, READ_MODE); // read parameter 
-        IsOK_Report_Err_Warn("Hardware Error21", CMD_FREQUENCY | CMND_READ_MASK) ;  // check if no warnings and errors
+        uint32_t resultTemp;
+        Shadow_ReadParam(CMD_FREQUENCY, &resultTemp, false, "Hardware Error21");  // read parameter (shadow copy if we have it), check if no warnings and errors
 
         Bridge_SerialPrint("Cal Freq = ");    
         floatResult = ConvInt32ToFloat(resultTemp) / 1000;            // convert the result straight into single precision floating  and divide by 1000 (kHz)
-        Bridge_SerialPrint(String(floatResult, 4));                     // report the response as floating point
+        Out_Float(floatResult, 4);                     // report the response as floating point
         Bridge_SerialPrintLn("kHz");                                    // add the pos string at the end
 
         //---- TIME report
@@ -162,13 +537,17 @@ unsigned long currMillisecond = millis();
         { 
           Bridge_SerialPrint("Cal Temp: ");                   // the cal temperature is
           floatResult = ConvInt32ToFloat(resultTemp);         // convert the result straight into single precision floating  and divide by 1000 (kHz)
-          Bridge_SerialPrintLn(String(floatResult, 1));         // report the response as floating point with single precision
+          Out_Float(floatResult, 1);         // report the response as floating point with single precision
+          Bridge_SerialPrintLn();
         }
 
 
         // output calibration status - which CAL were done
-        uint32_t current_V_GAIN = SingleParamReadWrite_waitDone(CMD_VOLTAGE_GAIN     | CMND_READ_MASK, 0, 0, READ_MODE) & 0x03;  // store the V gain
-        uint32_t current_I_GAIN = SingleParamReadWrite_waitDone(CMD_CURRENT_GAIN     | CMND_READ_MASK, 0, 0, READ_MODE) & 0x03;  // store the I gain
+        uint32_t current_V_GAIN, current_I_GAIN;
+        Shadow_ReadParam(CMD_VOLTAGE_GAIN, &current_V_GAIN, false, NULL);  // store the V gain
+        Shadow_ReadParam(CMD_CURRENT_GAIN, &current_I_GAIN, false, NULL);  // store the I gain
+        current_V_GAIN &= 0x03;
+        current_I_GAIN &= 0x03;
                                                                           //@@@WORK_AND_FIX - shift is 9 but needs 10
         resultTemp = SingleParamReadWrite_waitDone(CMD_CAL_READ, (CALL_ADDR_AC_STATUS << SHIFT_ADDR_READ_CAL) | \
                                                       ((current_I_GAIN & 0x03) << 2) | (current_V_GAIN & 0x03), 0, READ_MODE);  // Request reading Ro coeff LSB
@@ -224,6 +603,7 @@ unsigned long currMillisecond = millis();
       
       if (flag_DONE) { // it's ACTIVE_CALIBRATE_ERASE and we just got DONE flag to move to next stage
         if (flag_ERROR == false) {
+          CalIndex_Clear();          // nothing is stored any more
           Bridge_SerialPrintLn("Erase : success");  
         } // no error
         else {
@@ -258,6 +638,8 @@ unsigned long currMillisecond = millis();
 
     } // was active ACTIVE_RELOAD_CAL task
 
-  }  // was repetitive task on 5ms (time for 5ms expired)    
+    nextPoll_us = micros() + NextPollInterval_us();   // schedule the next poll from what is running now
+
+  }  // was the poll due    
 
 } // End of the slow task
\ No newline at end of file
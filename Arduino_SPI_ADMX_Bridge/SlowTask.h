@@ -18,8 +18,19 @@
 #include "Arduino_SPI_ADMX_Bridge.h"    // load file with all definitions (like int myVar;) and declarations (extern int myVar;) 
 
 
+enum zFormat_t {ZFMT_ASCII, ZFMT_BINARY};  // Z record output format
+enum zStats_t {ZSTATS_OFF, ZSTATS_ONLY, ZSTATS_ALL};  // statistics of the run: none, summary only, records and summary
+enum zDerived_t {ZD_Z, ZD_PHASE, ZD_RS, ZD_XS, ZD_CS, ZD_CP, ZD_LS, ZD_LP, ZD_RP, ZD_D, ZD_Q, ZD_NUM};  // quantities computed from Rm/Xm and the frequency
+
 //--------- Function prototypes -----------------------------------------------------------
 void ExecuteSlowTask(void);   // here we execute commands on regular intervals like wait for DONE and wait for MEASURE_DONE
+void ReportZ_Record(const uint32_t resultFIFO[4], int recordsPending = 0);  // output one Z record (4 FIFO words) in the selected format, recordsPending - estimate of the records waiting, see DrainZ_fromFIFO()
+int  DrainZ_fromFIFO(void);   // pull all complete Z records from the FIFO within drainBudget_us, returns number of records
+void Flush_FIFO(void);        // throw away everything in the FIFO (after abort)
+void Scheduler_StartRun(void);  // Z run started - schedule the first poll for the first expected sample
+void ZStats_Start(void);      // clear the run statistics
+void ZStats_Report(void);     // output N, mean, std, min, max of Rm/Xm in the selected format
+void ZDerived_Start(void);    // take the measurement frequency for the derived quantities (before the run)
 
 //--------- External variables -----------------------------------------------------------
 extern int measureZ_counter;            // keeps track of the sequential samples (when count > 1)
@@ -29,12 +40,22 @@ extern int  depthFIFO;                  // how many record reside in the FIFO
 extern bool flag_MEASURE_DONE ;         // set flag measure done
 extern bool flag_DONE         ;         // set flag done
 extern bool flag_ERROR        ;         // do we have error or not
+extern bool flag_WARNING      ;         // do we have warning or not
 extern int pendingRec;
+extern unsigned long drainBudget_us;    // max time for one FIFO drain pass, 0 - one record per tick
+extern zFormat_t zOutFormat;            // ascii or binary Z records
+extern bool zStampEnabled;              // records carry sequence number, drain time and records pending
+extern uint32_t zSequence;              // record sequence number since power up
+extern zStats_t zStatsMode;             // statistics of the run on the bridge
+extern byte zDerivedList[];             // derived quantities in the output order
+extern int  zDerivedCount;              // how many of them, 0 - raw Rm/Xm records
 extern int inQueue;
 
 
 //---------- DEFINITIONS -----------------------------------------------------------------
-#define LARGEST_UNIGNED_LONG 4294967295  // this is the largest unsigned long number, we used it for compensation of rollower in millis()
 #define FLOAT_PRECISION   7              // how many digits floating point precision to output (7 in CLI)
+#define DEFAULT_DRAIN_BUDGET_US  2000    // one FIFO drain pass can take up to 2ms, then we let the main loop run
+#define MAX_DRAIN_BUDGET_US   1000000    // <drain> accepts up to 1s - longer passes would starve the USB input
+#define ZDERIVED_MAX             8       // max derived quantities in one record
 
 #endif // end  _SLOW_TASK_H
\ No newline at end of file
@@ -0,0 +1,60 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Queue of SPI frames with completion callbacks
+// IDEX Biometrics UK
+//
+// 17-10-26 -- Starting the implementation
+//================================================================
+#include <Arduino.h>
+#include <CircularBuffer.hpp>     // adds Circular buffer
+#include "SpiQueue.h"
+#include "CmndProcess.h"          // Single_ADMX_Frame() and frame timing
+
+CircularBuffer<spiFrame_t, SIZE_SPI_QUEUE> spiQueue;   // frames waiting for transmission
+
+//================================================================
+// Add a frame at the end of the queue
+//================================================================
+bool SpiQueue_Enqueue(byte command, uint16_t address, uint32_t dataOut, frameDone_t onDone, void *context)
+{
+  if (spiQueue.isFull()) {
+    return false;   // caller must service the queue first, we never overwrite frames
+  }
+
+  spiFrame_t newFrame = {command, address, dataOut, onDone, context};
+  spiQueue.push(newFrame);
+  return true;
+} // end of SpiQueue_Enqueue
+
+//================================================================
+// Send the next frame, but only if we don't have to wait for the gap
+//================================================================
+bool SpiQueue_Service(void)
+{
+  if (spiQueue.isEmpty() || !ADMX_FrameGapElapsed()) {
+    return false;   // nothing to do or too early - come back later
+  }
+
+  spiFrame_t nextFrame = spiQueue.shift();
+  uint32_t dataIn = Single_ADMX_Frame(nextFrame.command, nextFrame.address, nextFrame.dataOut);  // gap elapsed - no waiting inside
+
+  if (nextFrame.onDone != NULL) {
+    nextFrame.onDone(dataIn, nextFrame.context);   // completion
+  }
+  return true;
+} // end of SpiQueue_Service
+
+//================================================================
+// Send everything which is pending
+//================================================================
+void SpiQueue_Flush(void)
+{
+  while (!spiQueue.isEmpty()) {
+    SpiQueue_Service();
+  }
+} // end of SpiQueue_Flush
+
+//================================================================
+int SpiQueue_Pending(void) { return spiQueue.size(); }
+int SpiQueue_Free(void)    { return spiQueue.available(); }
+void SpiQueue_Clear(void)  { spiQueue.clear(); }
@@ -0,0 +1,39 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Queue of SPI frames with completion callbacks
+// IDEX Biometrics UK
+//
+// Callers put frames (command/address/data) into the queue and get the 32 bit response
+// through the callback. SpiQueue_Service() clocks out the next frame only when the
+// inter-frame gap has already elapsed, so it never waits - the time between frames
+// can be used for formatting and sending the previous record.
+//
+// 17-10-26 -- Creating the file
+//
+//================================================================
+#ifndef _SPI_QUEUE_H
+#define _SPI_QUEUE_H
+
+#include <Arduino.h>      // when we use definitions like byte, etc. we need to include it
+
+#define SIZE_SPI_QUEUE    16    // frames waiting for transmission (4 Z records)
+
+typedef void (*frameDone_t)(uint32_t dataIn, void *context);   // completion callback - response of the frame and caller's context
+
+struct spiFrame_t {
+  byte        command;     // SPI command
+  uint16_t    address;     // address field
+  uint32_t    dataOut;     // data we send
+  frameDone_t onDone;      // called with the response when the frame is done (can be NULL)
+  void       *context;     // passed to onDone
+};
+
+//--------- Function prototypes -----------------------------------------------------------
+bool SpiQueue_Enqueue(byte command, uint16_t address, uint32_t dataOut, frameDone_t onDone, void *context);  // FALSE when the queue is full
+bool SpiQueue_Service(void);   // send one frame if the gap has elapsed, TRUE if a frame was sent
+void SpiQueue_Flush(void);     // send all pending frames (waits for the gaps)
+int  SpiQueue_Pending(void);   // how many frames are waiting
+int  SpiQueue_Free(void);      // how many frames can be added
+void SpiQueue_Clear(void);     // drop all pending frames without sending them
+
+#endif  // end _SPI_QUEUE_H
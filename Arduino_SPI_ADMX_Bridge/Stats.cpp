@@ -0,0 +1,168 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Runtime counters
+// IDEX Biometrics UK
+//
+// 17-10-26 -- Starting the implementation
+//================================================================
+#include <Arduino.h>
+#include "CmndProcess.h"                // Bridge_SerialPrint()
+#include "SerialOut.h"                  // numbers straight into the TX ring
+#include "Arduino_SPI_ADMX_Bridge.h"    // sizes of the receive queues
+#include "Stats.h"
+
+#define STATS_NUM_OPCODES   256          // frames are counted by the whole command byte (read mask included)
+
+const unsigned long statsLoopLimit_us[STATS_LOOP_BUCKETS - 1] = {10, 50, 100, 500, 1000, 5000, 10000};  // upper limits of the buckets
+
+uint32_t statsFrames[STATS_NUM_OPCODES];   // SPI frames per command byte
+uint32_t statsFramesTotal;
+uint32_t statsDoneWaits;                   // WaitForDoneAndGetStatus() calls
+uint32_t statsStatusPolls;                 // status frames they took
+uint32_t statsDoneTimeouts;                // max_number_wait exhausted without DONE (single polls are not counted)
+int      statsInpQueueMax;                 // inpQueue high-water mark (chars)
+int      statsRecQueueMax;                 // recLenQueue high-water mark (lines)
+uint32_t statsRecords;                     // Z records drained
+uint32_t statsBytesOut;                    // bytes handed to USB
+uint32_t statsUsbWrites;                   // Serial.write() calls
+uint32_t statsLoops[STATS_LOOP_BUCKETS];   // loop period histogram
+unsigned long statsLoopMax_us;             // longest loop period
+unsigned long statsLastLoop_us;            // start of the previous loop
+bool     statsLoopStarted = false;         // FALSE - no previous loop to measure from
+unsigned long statsStart_ms = 0;           // when the counters were reset
+
+//================================================================
+void Stats_Frame(byte command)
+{
+  statsFrames[command]++;
+  statsFramesTotal++;
+}
+
+void Stats_DoneWait(int polls, bool timedOut)
+{
+  statsDoneWaits++;
+  statsStatusPolls += polls;
+  if (timedOut) {
+    statsDoneTimeouts++;
+  }
+}
+
+void Stats_QueueLevel(int inpChars, int recLines)
+{
+  if (inpChars > statsInpQueueMax) { statsInpQueueMax = inpChars; }
+  if (recLines > statsRecQueueMax) { statsRecQueueMax = recLines; }
+}
+
+void Stats_Records(int numRecords)
+{
+  statsRecords += numRecords;
+}
+
+void Stats_UsbWrite(int numBytes)
+{
+  statsBytesOut += numBytes;
+  statsUsbWrites++;
+}
+
+//================================================================
+// Loop period - from the start of the previous loop to the start of this one
+//================================================================
+void Stats_LoopTime(void)
+{
+  unsigned long now_us = micros();
+  if (statsLoopStarted) {
+    unsigned long period_us = now_us - statsLastLoop_us;   // unsigned difference is safe on micros() rollover
+    int bucket = 0;
+    while ((bucket < STATS_LOOP_BUCKETS - 1) && (period_us >= statsLoopLimit_us[bucket])) {
+      bucket++;
+    }
+    statsLoops[bucket]++;
+    if (period_us > statsLoopMax_us) {
+      statsLoopMax_us = period_us;
+    }
+  }
+  statsLastLoop_us = now_us;
+  statsLoopStarted = true;
+}
+
+//================================================================
+void Stats_Reset(void)
+{
+  memset(statsFrames, 0, sizeof(statsFrames));
+  memset(statsLoops, 0, sizeof(statsLoops));
+  statsFramesTotal = 0;
+  statsDoneWaits = statsStatusPolls = statsDoneTimeouts = 0;
+  statsInpQueueMax = statsRecQueueMax = 0;
+  statsRecords = statsBytesOut = statsUsbWrites = 0;
+  statsLoopMax_us = 0;
+  statsLoopStarted = false;      // the period of the loop running <stats reset> is not counted
+  statsStart_ms = millis();
+}
+
+//================================================================
+// <stats> - one counter group per line
+//================================================================
+void Stats_Report(void)
+{
+  Bridge_SerialPrint("stats = ");
+  Out_UInt(millis() - statsStart_ms);
+  Bridge_SerialPrintLn(" ms");
+
+  Bridge_SerialPrint("frames = ");
+  Out_UInt(statsFramesTotal);
+  Bridge_SerialPrint(", done waits = ");
+  Out_UInt(statsDoneWaits);
+  Bridge_SerialPrint(", status polls = ");
+  Out_UInt(statsStatusPolls);
+  Bridge_SerialPrint(", timeouts = ");
+  Out_UInt(statsDoneTimeouts);
+  Bridge_SerialPrintLn();
+
+  for (int ii = 0; ii < STATS_NUM_OPCODES; ii++) {   // only the opcodes which were used
+    if (statsFrames[ii] != 0) {
+      Bridge_SerialPrint("  0x");
+      if (ii < 0x10) {
+        Out_Char('0');
+      }
+      Out_Hex(ii);
+      Bridge_SerialPrint(" = ");
+      Out_UInt(statsFrames[ii]);
+      Bridge_SerialPrintLn();
+    }
+  }
+
+  Bridge_SerialPrint("inpQueue max = ");
+  Out_Int(statsInpQueueMax);
+  Out_Char('/');
+  Out_Int(SIZE_RECEIVER_QUEUE);
+  Bridge_SerialPrint(", recLenQueue max = ");
+  Out_Int(statsRecQueueMax);
+  Out_Char('/');
+  Out_Int(SIZE_RECORD_LEN_QUEUE);
+  Bridge_SerialPrintLn();
+
+  Bridge_SerialPrint("records = ");
+  Out_UInt(statsRecords);
+  Bridge_SerialPrint(", bytes out = ");
+  Out_UInt(statsBytesOut);
+  Bridge_SerialPrint(", usb writes = ");
+  Out_UInt(statsUsbWrites);
+  Bridge_SerialPrintLn();
+
+  Bridge_SerialPrint("loop max = ");
+  Out_UInt(statsLoopMax_us);
+  Bridge_SerialPrintLn(" us");
+  for (int ii = 0; ii < STATS_LOOP_BUCKETS; ii++) {
+    if (ii < STATS_LOOP_BUCKETS - 1) {
+      Bridge_SerialPrint("  <");
+      Out_UInt(statsLoopLimit_us[ii]);
+    }
+    else {
+      Bridge_SerialPrint("  >=");
+      Out_UInt(statsLoopLimit_us[ii - 1]);
+    }
+    Bridge_SerialPrint(" us = ");
+    Out_UInt(statsLoops[ii]);
+    Bridge_SerialPrintLn();
+  }
+} // end of Stats_Report()
@@ -0,0 +1,30 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Runtime counters - <stats> and <stats reset>
+// IDEX Biometrics UK
+//
+// SPI frames per opcode, status polls and DONE timeouts, high-water marks of the
+// receive queues, Z records drained, bytes/writes to USB and a histogram of the
+// main loop period. The counters only count - the report is made by <stats>.
+//
+// 17-10-26 -- Creating the file
+//
+//================================================================
+#ifndef _STATS_H
+#define _STATS_H
+
+#include <Arduino.h>      // when we use definitions like byte, etc. we need to include it
+
+#define STATS_LOOP_BUCKETS    8     // loop period histogram, the last bucket has no upper limit
+
+//--------- Function prototypes -----------------------------------------------------------
+void Stats_Frame(byte command);                 // one SPI frame sent
+void Stats_DoneWait(int polls, bool timedOut);  // WaitForDoneAndGetStatus() - status frames it took, max_number_wait exhausted
+void Stats_QueueLevel(int inpChars, int recLines);  // receive queues after a push - keeps the high-water marks
+void Stats_Records(int numRecords);             // Z records drained from FIFO
+void Stats_UsbWrite(int numBytes);              // one Serial.write()
+void Stats_LoopTime(void);                      // called at the start of every loop() - period since the last call
+void Stats_Reset(void);
+void Stats_Report(void);                        // print all counters (without the delimiter)
+
+#endif  // end _STATS_H
@@ -0,0 +1,189 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Frequency sweep driven by the bridge
+// IDEX Biometrics UK
+//
+// 17-10-26 -- Starting the implementation
+//================================================================
+#include <Arduino.h>
+#include "SPI_cmnd.h"        // SPI commands definitions
+#include "ANSI_cmnd.h"       // sweep scale values
+#include "CmndProcess.h"     // SingleParamReadWrite_waitDone(), MeasureZ_Start()
+#include "SlowTask.h"        // measureZ_counter, flag_ERROR
+#include "ShadowCache.h"     // settings we write back come from the copy
+#include "Sweep.h"
+
+#define SWEEP_TYPE_OFF_VAL    0     // sweep_type off
+#define SWEEP_TYPE_FREQ_VAL   1     // sweep_type frequency
+
+sweepMode_t sweepMode = SWEEP_NONE;
+float    sweepPointHz[SWEEP_POINTS_MAX];   // module sweep - point frequencies read back from the module
+int      sweepPoints;                // module sweep points (= count)
+float    sweepList[SWEEP_LIST_MAX];  // list sweep frequencies
+int      sweepListLen = 0;
+int      sweepListPos = 0;           // point being measured
+int      sweepRecordBase = 0;        // records of the finished list points
+uint32_t savedSweepType, savedCount, savedFreq;   // written back at the end
+uint32_t savedStart, savedEnd, savedScale;        // module sweep range, written back too
+
+//================================================================
+// Write one setting, keep it in the shadow copy - FALSE on error (reported)
+//================================================================
+static bool Sweep_WriteParam(byte command, uint32_t value)
+{
+  SingleParamReadWrite_waitDone(command, 0, value, WRITE_MODE);
+  Shadow_NoteWrite(command, value);
+  return IsOK_Report_Err_Warn("Sweep", command);
+}
+
+//================================================================
+// Keep sweep_type/count/frequency (and the sweep range for a module sweep) - the sweep changes them
+//================================================================
+static bool Sweep_SaveSettings(bool moduleSweep)
+{
+  if (moduleSweep) {
+    if (!Shadow_ReadParam(CMD_SWEEP_START, &savedStart, false, "Sweep") ||
+        !Shadow_ReadParam(CMD_SWEEP_END,   &savedEnd,   false, "Sweep") ||
+        !Shadow_ReadParam(CMD_SWEEP_SCALE, &savedScale, false, "Sweep")) {
+      return false;
+    }
+  }
+  return Shadow_ReadParam(CMD_SWEEP_TYPE, &savedSweepType, false, "Sweep") &&
+         Shadow_ReadParam(CMD_COUNT,      &savedCount,     false, "Sweep") &&
+         Shadow_ReadParam(CMD_FREQUENCY,  &savedFreq,      false, "Sweep");
+}
+
+//================================================================
+// Sweep ended (or failed) - settings back as they were before
+//================================================================
+static void Sweep_End(void)
+{
+  if (sweepMode == SWEEP_MODULE) {
+    Sweep_WriteParam(CMD_SWEEP_START, savedStart);
+    Sweep_WriteParam(CMD_SWEEP_END, savedEnd);
+    Sweep_WriteParam(CMD_SWEEP_SCALE, savedScale);
+    Sweep_WriteParam(CMD_SWEEP_TYPE, savedSweepType);
+    Sweep_WriteParam(CMD_COUNT, savedCount);
+  }
+  else if (sweepMode == SWEEP_LIST) {
+    Sweep_WriteParam(CMD_SWEEP_TYPE, savedSweepType);
+    Sweep_WriteParam(CMD_FREQUENCY, savedFreq);
+  }
+  sweepMode = SWEEP_NONE;
+}
+
+//================================================================
+// Module sweep - start/stop/points/scale into the module, one Z run
+//================================================================
+bool Sweep_StartRange(float startHz, float stopHz, int numPoints, int scale)
+{
+  if (!Sweep_SaveSettings(true)) {
+    return false;
+  }
+  sweepPoints  = numPoints;          // <sweep> refuses more than SWEEP_POINTS_MAX
+  sweepRecordBase = 0;
+  sweepMode = SWEEP_MODULE;          // from here Sweep_End() writes the settings back
+
+  if (!Sweep_WriteParam(CMD_SWEEP_START, ConvFloatToInt32(startHz)) ||
+      !Sweep_WriteParam(CMD_SWEEP_END,   ConvFloatToInt32(stopHz)) ||
+      !Sweep_WriteParam(CMD_SWEEP_SCALE, scale) ||
+      !Sweep_WriteParam(CMD_SWEEP_TYPE,  SWEEP_TYPE_FREQ_VAL) ||
+      !Sweep_WriteParam(CMD_COUNT,       numPoints)) {
+    Sweep_End();
+    return false;
+  }
+
+  for (int ii = 0; ii < numPoints; ii++) {   // the points as the module computed them (its rounding, its formula)
+    uint32_t rawFreq = SingleParamReadWrite_waitDone(CMD_READ_SWEEP_POINTS, ii, 0, READ_MODE);
+    if (!IsOK_Report_Err_Warn("Sweep points", CMD_READ_SWEEP_POINTS)) {
+      Sweep_End();
+      return false;
+    }
+    sweepPointHz[ii] = ConvInt32ToFloat(rawFreq);
+  }
+
+  MeasureZ_Start();                  // the module steps the points
+  return true;
+}
+
+//================================================================
+// List sweep - the bridge sets every frequency, <count> samples per point
+//================================================================
+bool Sweep_StartList(const float freqHz[], int numPoints)
+{
+  if (!Sweep_SaveSettings(false)) {
+    return false;
+  }
+  sweepListLen = numPoints;          // <sweep list> rejects more than SWEEP_LIST_MAX
+  memcpy(sweepList, freqHz, sweepListLen * sizeof(float));
+  sweepListPos = 0;
+  sweepRecordBase = 0;
+  sweepMode = SWEEP_LIST;
+
+  if (!Sweep_WriteParam(CMD_SWEEP_TYPE, SWEEP_TYPE_OFF_VAL) ||    // one frequency per Z run
+      !Sweep_WriteParam(CMD_FREQUENCY,  ConvFloatToInt32(sweepList[0]))) {
+    Sweep_End();
+    return false;
+  }
+
+  MeasureZ_Start();
+  return true;
+}
+
+//================================================================
+// Z run ended - start the next list point straight away, or end the sweep
+//================================================================
+bool Sweep_NextPoint(void)
+{
+  if (sweepMode == SWEEP_NONE) {
+    return false;
+  }
+
+  if ((sweepMode == SWEEP_LIST) && !flag_ERROR && (sweepListPos + 1 < sweepListLen)) {
+    sweepRecordBase += measureZ_counter;   // MeasureZ_Start() clears the counter
+    sweepListPos++;
+    if (Sweep_WriteParam(CMD_FREQUENCY, ConvFloatToInt32(sweepList[sweepListPos]))) {
+      MeasureZ_Start();
+      return true;
+    }
+  }
+
+  Sweep_End();
+  return false;
+}
+
+//================================================================
+// Sweep stopped from outside - the module has to be idle before the settings go back,
+// a running Z would not take them
+//================================================================
+void Sweep_Abort(bool moduleAborted)
+{
+  if (sweepMode == SWEEP_NONE) {
+    return;
+  }
+  if (!moduleAborted) {
+    SingleParamReadWrite_waitDone(CMD_ABORT, 0, 0, WRITE_MODE);   // waits for DONE
+  }
+  Sweep_End();
+}
+
+bool Sweep_Active(void)
+{
+  return (sweepMode != SWEEP_NONE);
+}
+
+int Sweep_RecordIndex(void)
+{
+  return sweepRecordBase + measureZ_counter;
+}
+
+//================================================================
+// Frequency of the current record - the point list read from the module at the start
+//================================================================
+float Sweep_RecordFreq(void)
+{
+  if (sweepMode == SWEEP_LIST) {
+    return sweepList[sweepListPos];
+  }
+  return sweepPointHz[min(measureZ_counter, sweepPoints - 1)];   // count = points, the guard is for a module running on
+}
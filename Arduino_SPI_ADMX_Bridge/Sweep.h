@@ -0,0 +1,40 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// Frequency sweep driven by the bridge
+// IDEX Biometrics UK
+//
+// <sweep start stop points [linear|log]> - the module sweeps by itself (sweep_start/sweep_end/
+//   sweep_scale/sweep_type frequency and count = points), the bridge adds the frequency of every point
+//   as the module reports it (CMD_READ_SWEEP_POINTS before the run) - no formula of ours
+// <sweep list f1 f2 f3 ...> - the bridge steps the frequencies, the next point is set up and started
+//   as soon as DONE of the previous one is seen, without a round trip to the host
+// Frequencies are given in kHz (as <frequency>), the records carry the point frequency in Hz.
+// Sweep type, count, frequency and the sweep range changed by the sweep are written back at the end.
+//
+// 17-10-26 -- Creating the file
+//
+//================================================================
+#ifndef _SWEEP_H
+#define _SWEEP_H
+
+#include <Arduino.h>      // when we use definitions like byte, etc. we need to include it
+
+#define SWEEP_LIST_MAX      64    // points of <sweep list>
+#define SWEEP_MIN_POINTS     2    // module sweep needs start and stop
+#define SWEEP_POINTS_MAX   256    // points of the module sweep - their frequencies are kept
+
+enum sweepMode_t {SWEEP_NONE, SWEEP_MODULE, SWEEP_LIST};
+
+//--------- Function prototypes -----------------------------------------------------------
+bool  Sweep_StartRange(float startHz, float stopHz, int numPoints, int scale);  // module sweep, FALSE if the setup failed (error printed)
+bool  Sweep_StartList(const float freqHz[], int numPoints);                    // bridge steps the list, FALSE if the setup failed
+bool  Sweep_NextPoint(void);     // Z run ended - TRUE if the next list point was started, otherwise the sweep ends (settings written back)
+void  Sweep_Abort(bool moduleAborted);   // abort/bridge reset - stop the module (unless already done), write the settings back, forget the sweep
+bool  Sweep_Active(void);        // TRUE - the records carry the point frequency
+int   Sweep_RecordIndex(void);   // record number from the start of the sweep
+float Sweep_RecordFreq(void);    // frequency (Hz) of the record being reported
+
+//--------- External variables -----------------------------------------------------------
+extern sweepMode_t sweepMode;
+
+#endif  // end _SWEEP_H
@@ -0,0 +1,131 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// SPI transaction trace
+// IDEX Biometrics UK
+//
+// 17-10-26 -- Starting the implementation
+//================================================================
+#include <Arduino.h>
+#include "CmndProcess.h"                // Bridge_SerialPrint()
+#include "SerialOut.h"                  // numbers straight into the TX ring
+#include "SPI_cmnd.h"                   // status register bits
+#include "Trace.h"
+
+traceEntry_t traceRing[TRACE_SIZE];     // the frames
+int          traceHead = 0;             // where the next frame goes
+int          traceCount = 0;            // frames in the ring (up to TRACE_SIZE)
+int          tracePostLeft = -1;        // frames till freeze after the trigger, -1 = not triggered
+long         traceTriggerAt = -1;      // dump index of the frame which triggered (last one recorded)
+uint32_t     traceTotal = 0;            // frames recorded since arm (the ring keeps only the last TRACE_SIZE)
+traceState_t traceState = TRACE_OFF;
+
+//================================================================
+// One frame - called from Single_ADMX_Frame(), must be cheap
+//================================================================
+void Trace_Frame(byte command, uint16_t address, uint32_t dataOut, uint32_t dataIn, uint32_t time_us)
+{
+  if (traceState != TRACE_ARMED) {
+    return;
+  }
+  traceEntry_t *entry = &traceRing[traceHead];
+  entry->time_us = time_us;
+  entry->command = command;
+  entry->address = address;
+  entry->dataOut = dataOut;
+  entry->dataIn  = dataIn;
+  traceHead = (traceHead + 1) & TRACE_MASK;
+  if (traceCount < TRACE_SIZE) {
+    traceCount++;
+  }
+  traceTotal++;
+
+  if (tracePostLeft < 0) {              // not triggered yet - is this a status with an error?
+    if ((command == CMD_STATUS_READ) &&
+        (((dataIn & ADMX200X_STATUS_DONE_BITM) && (dataIn & ADMX200X_STATUS_ERROR_BITM)) || (dataIn & ADMX200X_STATUS_FIFO_ERROR_BITM))) {
+      Trace_Trigger();
+    }
+  }
+  else if (tracePostLeft-- == 0) {
+    traceState = TRACE_FROZEN;
+  }
+}
+
+//================================================================
+void Trace_Trigger(void)
+{
+  if ((traceState == TRACE_ARMED) && (tracePostLeft < 0)) {
+    tracePostLeft  = TRACE_POST_FRAMES - 1;   // this frame is already in
+    traceTriggerAt = (long)traceTotal - 1;   // dump index of the last frame in (the dump counts from 0)
+  }
+}
+
+void Trace_Arm(void)
+{
+  traceHead = traceCount = 0;
+  traceTotal = 0;
+  tracePostLeft = traceTriggerAt = -1;
+  traceState = TRACE_ARMED;
+}
+
+void Trace_Off(void)
+{
+  traceState = TRACE_OFF;
+  traceHead = traceCount = 0;
+  traceTotal = 0;
+  tracePostLeft = traceTriggerAt = -1;
+}
+
+void Trace_Freeze(void)
+{
+  if (traceState == TRACE_ARMED) {
+    traceState = TRACE_FROZEN;
+  }
+}
+
+//================================================================
+// <trace> - trace = armed, frames 57/128, trigger at 42
+//================================================================
+void Trace_Report(void)
+{
+  static const char *stateName[] = {"off", "armed", "frozen"};
+
+  Bridge_SerialPrint("trace = ");
+  Bridge_SerialPrint(stateName[traceState]);
+  Bridge_SerialPrint(", frames ");
+  Out_UInt(traceTotal);
+  Out_Char('/');
+  Out_Int(TRACE_SIZE);
+  if (traceTriggerAt >= 0) {
+    Bridge_SerialPrint(", trigger at ");
+    Out_Int(traceTriggerAt);
+  }
+  Bridge_SerialPrintLn();
+}
+
+//================================================================
+// <trace dump> - index,time_us,command,address,data out,data in - the oldest first
+// the index counts from the arm, so the trigger frame can be found in the dump
+//================================================================
+void Trace_Dump(void)
+{
+  Trace_Report();
+  int pos = (traceHead - traceCount) & TRACE_MASK;      // the oldest frame
+  uint32_t index = traceTotal - traceCount;
+  for (int ii = 0; ii < traceCount; ii++) {
+    const traceEntry_t *entry = &traceRing[pos];
+    Out_UInt(index + ii);
+    Out_Char(',');
+    Out_UInt(entry->time_us);
+    Bridge_SerialPrint(",0x");
+    Out_Hex(entry->command);
+    Bridge_SerialPrint(",0x");
+    Out_Hex(entry->address);
+    Bridge_SerialPrint(",0x");
+    Out_Hex(entry->dataOut);
+    Bridge_SerialPrint(",0x");
+    Out_Hex(entry->dataIn);
+    Bridge_SerialPrintLn();
+    pos = (pos + 1) & TRACE_MASK;
+    Out_Service();                      // a full ring is ~6kB, let USB take it while we go
+  }
+} // end of Trace_Dump()
@@ -0,0 +1,42 @@
+//================================================================
+// ADMX2001B USB to SPI bridge
+// SPI transaction trace - <trace arm|off|freeze|dump>
+// IDEX Biometrics UK
+//
+// Every Single_ADMX_Frame() goes into a RAM ring (time, command, address, data out,
+// data in) while the trace is armed. An error/FIFO error in a status frame or a DONE
+// timeout freezes the ring after a few more frames, so the frames around the problem
+// stay there till they are dumped. Unlike the LIF box it costs only a few us per frame.
+//
+// 17-10-26 -- Creating the file
+//
+//================================================================
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <Arduino.h>      // when we use definitions like byte, etc. we need to include it
+
+#define TRACE_SIZE            128   // frames kept in the ring - must be power of 2
+#define TRACE_MASK            (TRACE_SIZE - 1)
+#define TRACE_POST_FRAMES     16    // frames still recorded after the trigger (error codes read, etc.)
+
+typedef struct {
+  uint32_t time_us;     // micros() when SS went high
+  uint32_t dataOut;     // data sent
+  uint32_t dataIn;      // data received
+  uint16_t address;
+  byte     command;
+} traceEntry_t;
+
+enum traceState_t {TRACE_OFF, TRACE_ARMED, TRACE_FROZEN};
+
+//--------- Function prototypes -----------------------------------------------------------
+void Trace_Frame(byte command, uint16_t address, uint32_t dataOut, uint32_t dataIn, uint32_t time_us);  // one SPI frame, recorded only when armed
+void Trace_Trigger(void);                       // error/timeout seen - freeze after TRACE_POST_FRAMES
+void Trace_Arm(void);                           // clear the ring and start recording
+void Trace_Off(void);                           // stop recording, the ring is cleared
+void Trace_Freeze(void);                        // stop recording now, keep the ring for the dump
+void Trace_Report(void);                        // one line - state and number of frames
+void Trace_Dump(void);                          // all frames, the oldest first (without the delimiter)
+
+#endif  // end _TRACE_H
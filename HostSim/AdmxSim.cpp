@@ -0,0 +1,456 @@
+//================================================================
+// ADMX2001B USB to SPI bridge - host simulator
+// Behavioural model of the ADMX2001 SPI register protocol
+// IDEX Biometrics UK
+//
+// 17-10-26 -- Creating the file
+//
+//================================================================
+#include <string.h>
+#include <math.h>
+#include "Arduino.h"
+#include "AdmxSim.h"
+#include "../Arduino_SPI_ADMX_Bridge/SPI_cmnd.h"   // the same opcodes and status bits the bridge uses
+
+AdmxSim admxSim;   // the single module on the bus
+
+#define NS_PER_US   1000ULL
+#define NEVER_NS    0xFFFFFFFFFFFFFFFFULL
+
+static uint32_t FloatBits(float val)   { uint32_t bits; memcpy(&bits, &val, 4); return bits; }
+static float    BitsFloat(uint32_t bits) { float val; memcpy(&val, &bits, 4); return val; }
+static uint64_t DoubleBits(double val) { uint64_t bits; memcpy(&bits, &val, 8); return bits; }
+
+//================================================================
+AdmxSim::AdmxSim(void)
+{
+  for (int ii = 0; ii < 256; ii++) {
+    cfg.latencyUs[ii] = 30;            // parameter access is quick on the module
+  }
+  cfg.latencyUs[CMD_CLEAR_ERROR]  = 10;
+  cfg.latencyUs[CMD_WARNING_READ] = 20;
+  cfg.samplePeriodUs = 0;              // derive from frequency/average/mdelay
+  cfg.calTimeUs      = 20000;
+  cfg.commitTimeUs   = 30000;
+  cfg.eraseTimeUs    = 100000;
+  strcpy(cfg.erasePassword, "admx");  // the erase needs it, a wrong one fails the command
+  cfg.reloadTimeUs   = 5000;
+  cfg.resetTimeUs    = 60000;
+  cfg.dutR           = 100.0;          // 100 Ohm in series with 1 nF
+  cfg.dutC           = 1e-9;
+
+  framesTotal = samplesProduced = fifoOverflows = 0;
+  memset(framesByOpcode, 0, sizeof(framesByOpcode));
+
+  selected  = false;
+  byteIndex = 0;
+  readWord  = 0;
+  memset(frame, 0, sizeof(frame));
+
+  DefaultAttributes();
+  resultReg = 0;
+  errorCode = 0;
+  errorFlag = false;
+  warningCodes = 0;
+  fifoError = false;
+  doneAtNs  = 0;
+  measuring = false;
+  samplesLeft = 0;
+  nextSampleNs = 0;
+  sampleIndex = 0;
+
+  memset(calCoeff,  0, sizeof(calCoeff));
+  memset(calStatus, 0, sizeof(calStatus));
+  memset(calStored, 0, sizeof(calStored));
+  memset(calFreq,   0, sizeof(calFreq));
+  memset(calTemp,   0, sizeof(calTemp));
+  memset(erasePwIn, 0, sizeof(erasePwIn));
+  loadRt = loadXt = 0;
+}
+
+//================================================================
+void AdmxSim::DefaultAttributes(void)
+{
+  memset(attr, 0, sizeof(attr));
+  attr[CMD_FREQUENCY]        = FloatBits(1000.0f);   // Hz
+  attr[CMD_MAGNITUDE]        = FloatBits(1.0f);
+  attr[CMD_OFFSET]           = FloatBits(0.0f);
+  attr[CMD_MDELAY]           = FloatBits(0.0f);
+  attr[CMD_TDELAY]           = FloatBits(0.0f);
+  attr[CMD_SWEEP_START]      = FloatBits(1000.0f);
+  attr[CMD_SWEEP_END]        = FloatBits(10000.0f);
+  attr[CMD_AVERAGE]          = 1;
+  attr[CMD_COUNT]            = 1;
+  attr[CMD_TCOUNT]           = 1;
+  attr[CMD_CELSIUS]          = 1;
+  attr[CMD_ENABLE_AUTORANGE] = 1;
+}
+
+//================================================================
+float AdmxSim::AttrFloat(uint8_t opcode)
+{
+  return BitsFloat(attr[opcode & 0x7F]);
+}
+
+//================================================================
+// Time per Z sample - settling (mdelay) plus a few signal periods per average
+//================================================================
+double AdmxSim::SampleTimeUs(void)
+{
+  if (cfg.samplePeriodUs > 0) {
+    return cfg.samplePeriodUs;
+  }
+
+  double freq = AttrFloat(CMD_FREQUENCY);
+  double periodUs = (freq > 0) ? 1e6 / freq : 1000;
+  double perAverage = 4 * periodUs;           // four signal periods per measurement
+  if (perAverage < 250) {
+    perAverage = 250;                         // DFT/processing floor
+  }
+  uint32_t average = attr[CMD_AVERAGE] ? attr[CMD_AVERAGE] : 1;
+  return AttrFloat(CMD_MDELAY) * 1000.0 + average * perAverage;
+}
+
+//================================================================
+void AdmxSim::StartCommand(uint64_t durationUs)
+{
+  doneAtNs = HostSim_NowNs() + durationUs * NS_PER_US;
+}
+
+//================================================================
+void AdmxSim::SetError(uint32_t code)
+{
+  errorFlag = true;
+  errorCode = code;
+}
+
+//================================================================
+// Point of the frequency sweep - the module keeps the point list as float
+//================================================================
+double AdmxSim::SweepPointHz(uint32_t index)
+{
+  double fStart = AttrFloat(CMD_SWEEP_START);
+  double fEnd   = AttrFloat(CMD_SWEEP_END);
+  double ratio  = (double)index / (attr[CMD_COUNT] - 1);
+  return (float)((attr[CMD_SWEEP_SCALE] == 1) ? fStart * pow(fEnd / fStart, ratio) : fStart + (fEnd - fStart) * ratio);
+}
+
+//================================================================
+// Push the samples which should be ready by now into the FIFO
+//================================================================
+void AdmxSim::Update(void)
+{
+  uint64_t now = HostSim_NowNs();
+
+  while (measuring && (now >= nextSampleNs)) {
+    double freq = AttrFloat(CMD_FREQUENCY);
+    if ((attr[CMD_SWEEP_TYPE] == 1) && (attr[CMD_COUNT] > 1)) {   // frequency sweep - each sample is a new point
+      freq = SweepPointHz(sampleIndex);
+    }
+
+    double omega = 2 * M_PI * freq;
+    double Rm = cfg.dutR + 0.001 * (sampleIndex % 7);          // small deterministic ripple
+    double Xm = -1.0 / (omega * cfg.dutC);
+    uint64_t bitsR = DoubleBits(Rm);
+    uint64_t bitsX = DoubleBits(Xm);
+
+    if (fifo.size() + 4 <= SIM_FIFO_SIZE_WORDS) {
+      fifo.push_back((uint32_t)bitsR);
+      fifo.push_back((uint32_t)(bitsR >> 32));
+      fifo.push_back((uint32_t)bitsX);
+      fifo.push_back((uint32_t)(bitsX >> 32));
+    }
+    else {
+      fifoOverflows++;
+      fifoError = true;
+    }
+    samplesProduced++;
+    sampleIndex++;
+
+    if (--samplesLeft == 0) {
+      measuring = false;
+      doneAtNs  = nextSampleNs + cfg.latencyUs[CMD_Z] * NS_PER_US;   // DONE follows the last sample
+    }
+    else {
+      nextSampleNs += (uint64_t)(SampleTimeUs() * NS_PER_US);
+    }
+  }
+}
+
+//================================================================
+void AdmxSim::Select(bool active)
+{
+  if (active) {
+    selected  = true;
+    byteIndex = 0;
+  }
+  else {
+    if (selected && (byteIndex == 7)) {
+      ExecuteFrame();
+    }
+    selected = false;
+  }
+}
+
+//================================================================
+uint8_t AdmxSim::Transfer(uint8_t mosi)
+{
+  uint8_t miso = 0;
+  if (!selected || (byteIndex >= 7)) {
+    return 0;   // not addressed or frame too long - ignore
+  }
+
+  if (byteIndex >= 3) {
+    miso = (uint8_t)(readWord >> (8 * (6 - byteIndex)));   // data phase - MSB first
+  }
+  frame[byteIndex++] = mosi;
+
+  if (byteIndex == 3) {   // command and address are known - prepare the data phase
+    Update();
+    readWord = PrepareReadWord();
+  }
+  return miso;
+}
+
+//================================================================
+uint32_t AdmxSim::PrepareReadWord(void)
+{
+  switch (frame[0]) {
+    case CMD_STATUS_READ: {
+      uint32_t status = 0;
+      bool done = HostSim_NowNs() >= doneAtNs;
+      size_t depth = fifo.size();
+      if (done) {
+        status |= ADMX200X_STATUS_DONE_BITM;
+        if (errorFlag)    status |= ADMX200X_STATUS_ERROR_BITM | (errorCode & ADMX200X_STATUS_CODE_BITM);
+        if (warningCodes) status |= ADMX200X_STATUS_WARN_BITM;
+      }
+      if (!measuring)     status |= ADMX200X_STATUS_MEASURE_DONE_BITM;
+      if (fifoError)      status |= ADMX200X_STATUS_FIFO_ERROR_BITM;
+      status |= ((uint32_t)depth << 16) & ADMX200X_STATUS_FIFO_DEPTH_BITM;
+      return status;
+    }
+    case CMD_RESULT_READ:
+      return resultReg;
+
+    case CMD_FIFO_READ: {
+      if (fifo.empty()) {
+        fifoError = true;   // underflow
+        return 0;
+      }
+      uint32_t word = fifo.front();
+      fifo.pop_front();
+      return word;
+    }
+    default:
+      return 0;
+  }
+}
+
+//================================================================
+// Complete frame was received - execute the command
+//================================================================
+void AdmxSim::ExecuteFrame(void)
+{
+  uint8_t  cmd  = frame[0];
+  uint16_t addr = ((uint16_t)frame[1] << 8) | frame[2];
+  uint32_t data = ((uint32_t)frame[3] << 24) | ((uint32_t)frame[4] << 16) | ((uint32_t)frame[5] << 8) | frame[6];
+
+  framesTotal++;
+  framesByOpcode[cmd]++;
+
+  if ((cmd == CMD_STATUS_READ) || (cmd == CMD_RESULT_READ) || (cmd == CMD_FIFO_READ)) {
+    return;   // pure reads - no change of the command state
+  }
+
+  Update();
+  if (cmd != CMD_WARNING_READ) {   // every new command starts with clean error/warning state
+    errorFlag = false;
+    errorCode = 0;
+    warningCodes = 0;
+  }
+  StartCommand(cfg.latencyUs[cmd]);
+
+  int gainIdx = (((addr >> 2) & 0x03) << 2) | (addr & 0x03);   // igain << 2 | vgain
+
+  switch (cmd) {
+    case CMD_CLEAR_ERROR:
+      fifoError = false;
+      break;
+
+    case CMD_WARNING_READ:
+      resultReg = warningCodes;
+      break;
+
+    case CMD_READ_SWEEP_POINTS:      // address = point index, the frequency (float) into the result register
+      if ((attr[CMD_SWEEP_TYPE] == 1) && (attr[CMD_COUNT] > 1) && (addr < attr[CMD_COUNT])) {
+        resultReg = FloatBits((float)SweepPointHz(addr));
+      }
+      else {
+        SetError(ADMX_STATUS_INVALID_ADDRESS);
+      }
+      break;
+
+    case CMD_FW_VERSION:
+      resultReg = 0x01020500;
+      break;
+
+    case CMD_UNIQUE_ID:
+      resultReg = addr ? 0x0A0B0C0D : 0x12345678;
+      break;
+
+    case CMD_RESET:
+      DefaultAttributes();
+      fifo.clear();
+      measuring = false;
+      fifoError = false;
+      StartCommand(cfg.resetTimeUs);
+      break;
+
+    case CMD_ABORT:
+      measuring   = false;
+      samplesLeft = 0;
+      break;
+
+    case CMD_Z:
+      fifo.clear();
+      fifoError    = false;
+      samplesLeft  = attr[CMD_COUNT] ? attr[CMD_COUNT] : 1;
+      sampleIndex  = 0;
+      measuring    = true;
+      nextSampleNs = HostSim_NowNs() + (uint64_t)(SampleTimeUs() * NS_PER_US);
+      doneAtNs     = NEVER_NS;   // DONE is set after the last sample
+      break;
+
+    case CMD_CALIBRATE:
+      if ((addr == ADDRESS_SHORT_CAL) || (addr == ADDRESS_OPEN_CAL) || (addr == ADDRESS_LOAD_CAL)) {
+        int g = (attr[CMD_CURRENT_GAIN] & 0x03) << 2 | (attr[CMD_VOLTAGE_GAIN] & 0x03);
+        calStatus[g] |= (addr == ADDRESS_SHORT_CAL) ? 0x001 : (addr == ADDRESS_OPEN_CAL) ? 0x010 : 0x100;
+        calFreq[g] = AttrFloat(CMD_FREQUENCY);
+        calTemp[g] = 25.4f;
+        calStored[g] = true;
+        for (int ii = 0; ii < SIM_NUM_COEFF; ii++) {
+          calCoeff[g][ii] = 1.0 + 0.125 * ii + g;
+        }
+        fifo.clear();
+        samplesLeft  = 1;   // calibration returns one measured point
+        sampleIndex  = 0;
+        measuring    = true;
+        nextSampleNs = HostSim_NowNs() + (uint64_t)cfg.calTimeUs * NS_PER_US;
+        doneAtNs     = NEVER_NS;
+      }
+      else if (addr == ADDRESS_LOAD_CAL_SET_RT) { loadRt = BitsFloat(data); }
+      else if (addr == ADDRESS_LOAD_CAL_SET_XT) { loadXt = BitsFloat(data); }
+      else if (addr == ADDRESS_RELOAD_CAL)      { StartCommand(cfg.reloadTimeUs); }
+      else                                      { SetError(ADMX_STATUS_INVALID_ADDRESS); }
+      break;
+
+    case CMD_CAL_READ: {
+      int field = (addr >> SHIFT_ADDR_READ_CAL) & 0x1F;
+      bool msb  = (addr & MASK_MSB_COEFFICIENT) != 0;
+      if (field == CALL_ADDR_AC_STATUS)    { resultReg = calStatus[gainIdx]; }
+      else if (field == CALL_ADDR_AC_FREQ) { resultReg = FloatBits(calFreq[gainIdx]); }
+      else if (field == CALL_ADDR_AC_TEMP) { resultReg = FloatBits(calTemp[gainIdx]); }
+      else if (((field & 1) == 0) && (field / 2 < SIM_NUM_COEFF)) {
+        if (!calStored[gainIdx]) {
+          SetError(ADMX_STATUS_UNCOMMITED_CAL);
+          resultReg = 0;
+        }
+        else {
+          uint64_t bits = DoubleBits(calCoeff[gainIdx][field / 2]);
+          resultReg = msb ? (uint32_t)(bits >> 32) : (uint32_t)bits;
+        }
+      }
+      else {
+        SetError(ADMX_STATUS_INVALID_ADDRESS);
+      }
+      break;
+    }
+
+    case CMD_STORE_CAL: {
+      int token = (addr >> SHIFT_ADDR_STORE_CAL) & 0x0F;
+      if (token >= SIM_NUM_COEFF) {
+        SetError(ADMX_STATUS_INVALID_CAL_COEFF_TYPE);
+        break;
+      }
+      uint64_t bits = DoubleBits(calCoeff[gainIdx][token]);
+      if (addr & MASK_MSB_COEFFICIENT) { bits = (bits & 0xFFFFFFFFULL) | ((uint64_t)data << 32); }
+      else                             { bits = (bits & 0xFFFFFFFF00000000ULL) | data; }
+      memcpy(&calCoeff[gainIdx][token], &bits, 8);
+      calStored[gainIdx] = true;     // readable, the status stays as it is
+      break;
+    }
+
+    case CMD_RESET_CAL:
+      for (int g = 0; g < SIM_NUM_GAINS; g++) {
+        if ((addr == MASK_RESET_ALL_CAL) || (g == gainIdx)) {
+          calStatus[g] = 0;
+          calStored[g] = false;
+          memset(calCoeff[g], 0, sizeof(calCoeff[g]));
+        }
+      }
+      break;
+
+    case CMD_CAL_COMMIT:
+      if (addr == ADDRESS_CAL_COMMIT) {
+        StartCommand(cfg.commitTimeUs);
+      }
+      break;
+
+    case CMD_ERASE_CALIBRATION:
+      if (addr < ADDRESS_TIMESTAMP) {  // password chars
+        erasePwIn[addr] = (char)data;
+      }
+      else if (addr == ADDRESS_CAL_ERASE) {
+        if (strcmp(erasePwIn, cfg.erasePassword) == 0) {
+          memset(calStatus, 0, sizeof(calStatus));
+          memset(calStored, 0, sizeof(calStored));
+          memset(calCoeff,  0, sizeof(calCoeff));
+        }
+        else {
+          SetError(ADMX_STATUS_FAILED);   // wrong password - nothing is erased
+        }
+        memset(erasePwIn, 0, sizeof(erasePwIn));
+        StartCommand(cfg.eraseTimeUs);
+      }
+      break;
+
+    case CMD_BOARD_REV:
+    case CMD_STATE:
+    case CMD_SELF_TEST_STATUS:
+      resultReg = 0;
+      break;
+
+    default:
+      if (cmd & CMND_READ_MASK) {   // attribute read
+        uint8_t opcode = cmd & 0x7F;
+        if (opcode == CMD_TEMPERATURE) {
+          resultReg = FloatBits(25.4f);
+        }
+        else if (opcode >= CMD_FREQUENCY) {
+          resultReg = attr[opcode];
+        }
+        else {
+          SetError(ADMX_STATUS_INVALID_ATTRIBUTE);
+        }
+      }
+      else if (cmd >= CMD_FREQUENCY) {   // attribute write
+        attr[cmd] = data;
+        if ((cmd == CMD_MAGNITUDE) && (BitsFloat(data) > 1.0f)) {
+          attr[cmd] = FloatBits(1.0f);
+          warningCodes |= MAG_EXCEED_WARN;
+        }
+        if ((cmd == CMD_FREQUENCY) && ((BitsFloat(data) <= 0) || (BitsFloat(data) > 10e6f))) {
+          attr[cmd] = FloatBits(1000.0f);
+          SetError(ADMX_STATUS_ATTR_OUT_OF_RANGE);
+        }
+        if ((cmd == CMD_VOLTAGE_GAIN) || (cmd == CMD_CURRENT_GAIN)) {
+          attr[cmd] &= 0x03;
+        }
+      }
+      else {
+        SetError(ADMX_STATUS_INVALID_ATTRIBUTE);
+      }
+      break;
+  }
+}
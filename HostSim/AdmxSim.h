@@ -0,0 +1,98 @@
+//================================================================
+// ADMX2001B USB to SPI bridge - host simulator
+// Behavioural model of the ADMX2001 SPI register protocol
+// IDEX Biometrics UK
+//
+// The model sees the same 56 bit frames the bridge clocks out (command, address H/L,
+// data 31..0) and answers in the data phase of the same frame, like the module does:
+//  - STATUS word with MEASURE_DONE/DONE/ERROR/WARN/FIFO_ERROR bits and FIFO depth
+//  - RESULT, FIFO and WARNING reads
+//  - attribute read/write, Z measurement filling the FIFO, calibration, commit, erase
+// Command latency and FIFO fill rate can be configured to reproduce the real module timing.
+//
+// 17-10-26 -- Creating the file
+//
+//================================================================
+#ifndef _ADMX_SIM_H
+#define _ADMX_SIM_H
+
+#include <stdint.h>
+#include <deque>
+
+#define SIM_FIFO_SIZE_WORDS     1023    // depth field in the status word is 10 bits wide
+#define SIM_NUM_GAINS             16    // 4 voltage gains x 4 current gains
+#define SIM_NUM_COEFF             12    // Ro, Xo, Go, Bo, Rs, Xs, Gs, Bs, Rg, Xg, Gg, Bg
+
+struct AdmxSimConfig {
+  uint32_t latencyUs[256];          // time from command frame end to DONE, per opcode
+  uint32_t samplePeriodUs;          // when > 0 - fixed time per Z sample, otherwise derived from frequency/average/mdelay
+  uint32_t calTimeUs;               // time for open/short/load calibration
+  uint32_t commitTimeUs;            // time for commit into FLASH
+  uint32_t eraseTimeUs;             // time for erasing the FLASH
+  char     erasePassword[13];       // <calibrate erase> password, up to 12 chars
+  uint32_t reloadTimeUs;            // time for reloading the calibration
+  uint32_t resetTimeUs;             // time for module reset
+  double   dutR;                    // simulated DUT - series resistance in Ohm
+  double   dutC;                    // simulated DUT - series capacitance in F
+};
+
+class AdmxSim {
+public:
+  AdmxSim(void);
+
+  void     Select(bool active);     // SS pin went low (true) or high (false)
+  uint8_t  Transfer(uint8_t mosi);  // one SPI byte - returns the MISO byte
+
+  AdmxSimConfig cfg;                // timing configuration, can be changed at any moment
+
+  //-------- counters for the host driver reports
+  uint32_t framesTotal;             // all complete 56 bit frames
+  uint32_t framesByOpcode[256];     // complete frames split by opcode
+  uint32_t samplesProduced;         // Z samples pushed into the FIFO
+  uint32_t fifoOverflows;           // samples lost because the FIFO was full
+
+private:
+  void     ExecuteFrame(void);      // frame complete - run the command
+  uint32_t PrepareReadWord(void);   // what to return in the data phase
+  void     Update(void);            // progress the measurement to the current virtual time
+  void     StartCommand(uint64_t durationUs);
+  void     SetError(uint32_t code);
+  void     DefaultAttributes(void);
+  double   SampleTimeUs(void);
+  float    AttrFloat(uint8_t opcode);
+  double   SweepPointHz(uint32_t index);   // frequency of a sweep point - the Z samples and CMD_READ_SWEEP_POINTS
+
+  //-------- frame assembly
+  bool     selected;
+  int      byteIndex;
+  uint8_t  frame[7];
+  uint32_t readWord;
+
+  //-------- module state
+  uint32_t attr[128];               // attributes addressed by opcode (writes without the read mask)
+  uint32_t resultReg;               // result of the last read command
+  uint32_t errorCode;               // code in the low bits of the status
+  bool     errorFlag;
+  uint32_t warningCodes;
+  bool     fifoError;
+  uint64_t doneAtNs;                // when DONE becomes true
+  std::deque<uint32_t> fifo;
+
+  bool     measuring;               // Z or calibration is producing samples
+  uint32_t samplesLeft;
+  char     erasePwIn[13];           // password chars written before the erase trigger
+  uint64_t nextSampleNs;
+  uint32_t sampleIndex;
+
+  //-------- calibration storage
+  double   calCoeff[SIM_NUM_GAINS][SIM_NUM_COEFF];
+  uint32_t calStatus[SIM_NUM_GAINS];
+  bool     calStored[SIM_NUM_GAINS];   // coefficients exist (calibration or storecal) - the status can still be 0
+  float    calFreq[SIM_NUM_GAINS];
+  float    calTemp[SIM_NUM_GAINS];
+  float    loadRt, loadXt;
+};
+
+extern AdmxSim admxSim;
+
+#endif // end _ADMX_SIM_H
@@ -0,0 +1,114 @@
+//================================================================
+// ADMX2001B USB to SPI bridge - host simulator
+// Minimal Arduino API shim, enough to compile the bridge sketch on a PC
+// IDEX Biometrics UK
+//
+// 17-10-26 -- Creating the file, virtual clock, Serial, pins and String
+//
+//================================================================
+#ifndef _HOST_ARDUINO_H
+#define _HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef double  double_t_shim;
+
+#define HIGH    1
+#define LOW     0
+#define INPUT   0
+#define OUTPUT  1
+
+#define DEC     10
+#define HEX     16
+
+#define D0      0
+#define D1      1
+#define D10    10
+#define D11    11
+#define D12    12
+#define D13    13
+#define LED_RX 21
+#define LED_TX 22
+
+//-------- Virtual clock - every delay and every SPI byte advances it, nothing really sleeps
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void HostSim_AdvanceNs(uint64_t ns);   // advance the virtual clock (used by the shim itself)
+uint64_t HostSim_NowNs(void);          // current virtual time in ns
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int val);
+int  digitalRead(int pin);
+
+template <class T, class L> auto min(const T &a, const L &b) -> decltype((b < a) ? b : a) { return (b < a) ? b : a; }
+template <class T, class L> auto max(const T &a, const L &b) -> decltype((b < a) ? b : a) { return (a < b) ? b : a; }
+
+#define noInterrupts()
+#define interrupts()
+
+//-------- Arduino String - only the constructors the sketch uses
+class String {
+public:
+  String(const char *str = "") : s(str) {}
+  String(char c) : s(1, c) {}
+  String(int val, int base = DEC)           { FromInt((long)val, base); }
+  String(unsigned int val, int base = DEC)  { FromUInt((unsigned long)val, base); }
+  String(long val, int base = DEC)          { FromInt(val, base); }
+  String(unsigned long val, int base = DEC) { FromUInt(val, base); }
+  String(byte val, int base = DEC)          { FromUInt((unsigned long)val, base); }
+  String(float val, int decimals = 2)       { FromDouble(val, decimals); }
+  String(double val, int decimals = 2)      { FromDouble(val, decimals); }
+
+  const char *c_str(void) const { return s.c_str(); }
+  unsigned int length(void) const { return (unsigned int)s.length(); }
+  bool startsWith(const String &prefix) const { return s.compare(0, prefix.s.length(), prefix.s) == 0; }
+
+private:
+  std::string s;
+  void FromInt(long val, int base);
+  void FromUInt(unsigned long val, int base);
+  void FromDouble(double val, int decimals);
+};
+
+//-------- USB serial - input is fed by the host driver, output goes to the host console
+class HostSerial {
+public:
+  bool _dtr = false;
+  bool _rts = false;
+
+  void begin(unsigned long baud) { (void)baud; }
+  void rts(void) {}
+  void dtr(void) {}
+
+  int  available(void);
+  int  availableForWrite(void);
+  int  read(void);
+  int  peek(void);
+
+  size_t write(uint8_t c);
+  size_t write(const uint8_t *buf, size_t len);
+  size_t print(const char *str);
+  size_t print(const String &str) { return print(str.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int val, int base = DEC)           { return print(String(val, base)); }
+  size_t print(unsigned int val, int base = DEC)  { return print(String(val, base)); }
+  size_t print(long val, int base = DEC)          { return print(String(val, base)); }
+  size_t print(unsigned long val, int base = DEC) { return print(String(val, base)); }
+  size_t println(void) { return print("\r\n"); }
+  size_t println(const char *str) { size_t n = print(str); return n + print("\r\n"); }
+  size_t println(const String &str) { return println(str.c_str()); }
+  void   flush(void) {}
+};
+
+extern HostSerial Serial;
+
+#endif // end _HOST_ARDUINO_H
@@ -0,0 +1,56 @@
+//================================================================
+// ADMX2001B USB to SPI bridge - host simulator
+// Stand-in for the CircularBuffer library (same method names and semantics)
+// IDEX Biometrics UK
+//
+// 17-10-26 -- Creating the file
+//
+//================================================================
+#ifndef _HOST_CIRCULAR_BUFFER_HPP
+#define _HOST_CIRCULAR_BUFFER_HPP
+
+#include <stddef.h>
+
+template <typename T, size_t S>
+class CircularBuffer {
+public:
+  bool push(T value) {            // add at the tail, overwrites the head when full (returns false then)
+    buf[(head + count) % S] = value;
+    if (count < S) { count++; return true; }
+    head = (head + 1) % S;
+    return false;
+  }
+  bool unshift(T value) {         // add at the head, overwrites the tail when full
+    head = (head + S - 1) % S;
+    buf[head] = value;
+    if (count < S) { count++; return true; }
+    return false;
+  }
+  T shift(void) {                 // remove from the head
+    T value = buf[head];
+    head = (head + 1) % S;
+    count--;
+    return value;
+  }
+  T pop(void) {                   // remove from the tail
+    count--;
+    return buf[(head + count) % S];
+  }
+  T first(void) const { return buf[head]; }
+  T last(void) const  { return buf[(head + count + S - 1) % S]; }
+  T operator[](size_t index) const { return buf[(head + index) % S]; }
+
+  size_t size(void) const      { return count; }
+  size_t available(void) const { return S - count; }
+  size_t capacity(void) const  { return S; }
+  bool   isEmpty(void) const   { return count == 0; }
+  bool   isFull(void) const    { return count == S; }
+  void   clear(void)           { head = 0; count = 0; }
+
+private:
+  T buf[S];
+  size_t head = 0;
+  size_t count = 0;
+};
+
+#endif // end _HOST_CIRCULAR_BUFFER_HPP
@@ -0,0 +1,47 @@
+//================================================================
+// ADMX2001B USB to SPI bridge - host simulator
+// FspTimer shim (Renesas core) - one periodic timer on the virtual clock
+// IDEX Biometrics UK
+//
+// The callback is run from the clock advance as soon as the virtual time passes
+// the next period, the same way the overflow IRQ interrupts the sketch.
+//
+// 17-10-26 -- Creating the file
+//
+//================================================================
+#ifndef _HOST_FSPTIMER_H
+#define _HOST_FSPTIMER_H
+
+#include "Arduino.h"
+
+#define GPT_TIMER   0
+#define AGT_TIMER   1
+
+typedef enum {TIMER_MODE_PERIODIC, TIMER_MODE_ONE_SHOT} timer_mode_t;
+
+typedef struct {
+  void *p_context;
+} timer_callback_args_t;
+
+typedef void (*GPTimerCbk_f)(timer_callback_args_t *);
+
+class FspTimer {
+public:
+  static int8_t get_available_timer(uint8_t &type, bool force = false);   // only one channel in the simulator
+
+  bool begin(timer_mode_t mode, uint8_t type, uint8_t channel, float freq_hz, float duty_perc, GPTimerCbk_f cbk = nullptr, void *ctx = nullptr);
+  bool setup_overflow_irq(uint8_t priority = 12) { (void)priority; return true; }
+  bool open(void) { return true; }
+  bool start(void);
+  bool stop(void);
+  bool close(void) { return stop(); }
+
+  GPTimerCbk_f callback = nullptr;
+  void        *context  = nullptr;
+  uint64_t     period_ns = 0;
+  uint64_t     nextTick_ns = 0;     // virtual time of the next overflow
+  bool         running = false;
+  bool         oneShot = false;
+};
+
+#endif // end _HOST_FSPTIMER_H
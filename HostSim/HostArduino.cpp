@@ -0,0 +1,204 @@
+//================================================================
+// ADMX2001B USB to SPI bridge - host simulator
+// Implementation of the Arduino API shim on a virtual clock
+// IDEX Biometrics UK
+//
+// 17-10-26 -- Creating the file
+// 17-10-26 -- FspTimer channel on the virtual clock
+//
+//================================================================
+#include <deque>
+#include "Arduino.h"
+#include "SPI.h"
+#include "FspTimer.h"
+#include "AdmxSim.h"
+
+#define SIM_SS_PIN              10    // same pin as SPI_SS_PIN in the sketch
+#define DIGITAL_WRITE_COST_NS  200    // cost of one digitalWrite() on the Minima
+#define SPI_CALL_COST_NS       300    // software overhead of one SPI.transfer() call
+#define TIME_READ_COST_NS      100    // millis()/micros() cost - also lets code polling the clock make progress
+#define USB_WRITE_COST_NS     5000    // one Serial.write()/print() call - the CDC driver queues and flushes a USB packet
+#define USB_TX_ROOM            256    // what Serial.availableForWrite() reports (CDC TX FIFO)
+
+HostSerial Serial;
+SPIClass   SPI;
+
+static uint64_t simTimeNs = 0;              // the virtual clock
+static std::deque<uint8_t> serialRx;        // bytes sent by the host, waiting for Serial.read()
+
+void HostSim_SerialOut(const uint8_t *buf, size_t len);   // implemented by the host driver
+
+//================================================================
+// Virtual clock
+//================================================================
+static void SimAdvance(uint64_t ns);           // every clock advance - fires the timer IRQ when due
+
+void HostSim_AdvanceNs(uint64_t ns) { SimAdvance(ns); }
+uint64_t HostSim_NowNs(void)         { return simTimeNs; }
+
+unsigned long millis(void) { SimAdvance(TIME_READ_COST_NS); return (unsigned long)(simTimeNs / 1000000ULL); }
+unsigned long micros(void) { SimAdvance(TIME_READ_COST_NS); return (unsigned long)(simTimeNs / 1000ULL); }
+void delay(unsigned long ms)            { SimAdvance((uint64_t)ms * 1000000ULL); }
+void delayMicroseconds(unsigned int us) { SimAdvance((uint64_t)us * 1000ULL); }
+
+//================================================================
+// Timer - one FspTimer channel, the callback runs when the virtual time passes its period
+//================================================================
+static FspTimer *simTimer = nullptr;         // the channel handed out by get_available_timer()
+static bool      inTimerIrq = false;         // the callback advances the clock too - no nesting
+
+static void SimAdvance(uint64_t ns)
+{
+  simTimeNs += ns;
+  if (inTimerIrq || (simTimer == nullptr)) {
+    return;
+  }
+  inTimerIrq = true;
+  while (simTimer->running && (simTimeNs >= simTimer->nextTick_ns)) {
+    simTimer->nextTick_ns += simTimer->period_ns;
+    if (simTimer->oneShot) {
+      simTimer->running = false;
+    }
+    if (simTimer->callback) {
+      timer_callback_args_t args = {simTimer->context};
+      simTimer->callback(&args);
+    }
+  }
+  inTimerIrq = false;
+}
+
+int8_t FspTimer::get_available_timer(uint8_t &type, bool force)
+{
+  (void)force;
+  static bool taken = false;
+  if (taken) {
+    return -1;
+  }
+  taken = true;
+  type = GPT_TIMER;
+  return 0;
+}
+
+bool FspTimer::begin(timer_mode_t mode, uint8_t type, uint8_t channel, float freq_hz, float duty_perc, GPTimerCbk_f cbk, void *ctx)
+{
+  (void)type; (void)channel; (void)duty_perc;
+  if (freq_hz <= 0) {
+    return false;
+  }
+  callback  = cbk;
+  context   = ctx;
+  period_ns = (uint64_t)(1e9 / freq_hz);
+  oneShot   = (mode == TIMER_MODE_ONE_SHOT);
+  simTimer  = this;
+  return true;
+}
+
+bool FspTimer::start(void)
+{
+  nextTick_ns = simTimeNs + period_ns;        // the first overflow one period from now
+  running = true;
+  return true;
+}
+
+bool FspTimer::stop(void)
+{
+  running = false;
+  return true;
+}
+
+//================================================================
+// Pins - only the SS pin has a meaning, it frames the SPI transfers
+//================================================================
+void pinMode(int pin, int mode) { (void)pin; (void)mode; }
+
+void digitalWrite(int pin, int val)
+{
+  SimAdvance(DIGITAL_WRITE_COST_NS);
+  if (pin == SIM_SS_PIN) {
+    admxSim.Select(val == LOW);
+  }
+}
+
+int digitalRead(int pin) { (void)pin; return LOW; }
+
+//================================================================
+// SPI - every byte goes to the ADMX2001 model
+//================================================================
+uint8_t SPIClass::transfer(uint8_t data)
+{
+  SimAdvance(SPI_CALL_COST_NS + 8ULL * 1000000000ULL / clockHz);
+  return admxSim.Transfer(data);
+}
+
+void SPIClass::transfer(void *buf, size_t count)
+{
+  uint8_t *bytes = (uint8_t *)buf;
+  SimAdvance(SPI_CALL_COST_NS);
+  for (size_t ii = 0; ii < count; ii++) {
+    SimAdvance(8ULL * 1000000000ULL / clockHz);
+    bytes[ii] = admxSim.Transfer(bytes[ii]);
+  }
+}
+
+//================================================================
+// Serial
+//================================================================
+void HostSim_FeedInput(const char *str, size_t len)
+{
+  for (size_t ii = 0; ii < len; ii++) {
+    serialRx.push_back((uint8_t)str[ii]);
+  }
+}
+
+size_t HostSim_PendingInput(void) { return serialRx.size(); }
+
+int HostSerial::available(void) { return (int)serialRx.size(); }
+int HostSerial::availableForWrite(void) { return USB_TX_ROOM; }   // the host takes the data immediately
+
+int HostSerial::peek(void)
+{
+  return serialRx.empty() ? -1 : serialRx.front();
+}
+
+int HostSerial::read(void)
+{
+  if (serialRx.empty()) {
+    return -1;
+  }
+  uint8_t c = serialRx.front();
+  serialRx.pop_front();
+  return c;
+}
+
+size_t HostSerial::write(uint8_t c)                       { SimAdvance(USB_WRITE_COST_NS); HostSim_SerialOut(&c, 1); return 1; }
+size_t HostSerial::write(const uint8_t *buf, size_t len)  { SimAdvance(USB_WRITE_COST_NS); HostSim_SerialOut(buf, len); return len; }
+size_t HostSerial::print(const char *str)                 { return write((const uint8_t *)str, strlen(str)); }
+
+//================================================================
+// String conversions
+//================================================================
+void String::FromInt(long val, int base)
+{
+  if ((base == DEC) || (val >= 0)) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%ld", val);
+    s = buf;
+  }
+  else {
+    FromUInt((unsigned long)val, base);
+  }
+}
+
+void String::FromUInt(unsigned long val, int base)
+{
+  char buf[24];
+  snprintf(buf, sizeof(buf), (base == HEX) ? "%lx" : "%lu", val);
+  s = buf;
+}
+
+void String::FromDouble(double val, int decimals)
+{
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", decimals, val);
+  s = buf;
+}
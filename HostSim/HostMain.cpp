@@ -0,0 +1,185 @@
+//================================================================
+// ADMX2001B USB to SPI bridge - host simulator
+// Driver running setup()/loop() of the sketch against the ADMX2001 model
+// IDEX Biometrics UK
+//
+// Build from the repository root (no Arduino IDE needed):
+//   g++ -std=gnu++17 -O2 -I HostSim -o admx_sim HostSim/*.cpp Arduino_SPI_ADMX_Bridge/*.cpp
+//
+// Usage: admx_sim [options] [script]       (commands are read from stdin without script)
+//   -p          pipeline - send all command lines at once (default - send next line when the bridge is idle)
+//   -s <us>     fixed Z sample period in us (default - derived from frequency/average/mdelay)
+//   -l <op>=<us> DONE latency for opcode (hex) in us, e.g. -l 23=50
+//   -t <ms>     stop after this much virtual time (default 60000 ms)
+//   -q          quiet - don't print the bridge output, only the summary
+//   -r          raw - output bridge bytes unchanged (default shows the delimiter as <DL> and binary as <xx>)
+//
+// A script line "@<ms> command" is sent at that virtual time, without waiting for the bridge
+// to be idle (e.g. "@20 abort" during a long z).
+//
+// At the end a summary with the virtual time, frames per opcode and samples is printed on stderr.
+//
+// 17-10-26 -- Creating the file
+// 17-10-26 -- @<ms> lines sent at a given time
+// 17-10-26 -- script lines of any length
+//
+//================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+#include "CircularBuffer.hpp"
+#include "AdmxSim.h"
+#include "../Arduino_SPI_ADMX_Bridge/Arduino_SPI_ADMX_Bridge.h"
+#include "../Arduino_SPI_ADMX_Bridge/CmndProcess.h"
+
+#define LOOP_COST_NS   2000   // time of one empty loop() iteration on the Minima
+
+void setup(void);
+void loop(void);
+void HostSim_FeedInput(const char *str, size_t len);
+size_t HostSim_PendingInput(void);
+
+extern stateMeasureZ_t stateMeasureZ;
+extern int curCommandLen;
+extern CircularBuffer<int16_t, SIZE_RECORD_LEN_QUEUE> recLenQueue;
+
+static bool optQuiet = false;
+static bool optRaw   = false;
+static uint64_t bytesOut = 0;
+static uint64_t usbWrites = 0;    // Serial.write()/print() calls of the sketch
+
+//================================================================
+// Everything the sketch prints ends here
+//================================================================
+void HostSim_SerialOut(const uint8_t *buf, size_t len)
+{
+  bytesOut += len;
+  usbWrites++;
+  if (optQuiet) {
+    return;
+  }
+  if (optRaw) {
+    fwrite(buf, 1, len, stdout);
+    return;
+  }
+  for (size_t ii = 0; ii < len; ii++) {
+    uint8_t c = buf[ii];
+    if (c == '\r')                   { }
+    else if (c == 0x0C)              { fputs("<DL>\n", stdout); }
+    else if ((c == '\n') || ((c >= 0x20) && (c < 0x7F))) { fputc(c, stdout); }
+    else                             { printf("<%02X>", c); }
+  }
+}
+
+//================================================================
+static bool BridgeIdle(void)
+{
+  return (HostSim_PendingInput() == 0) && (recLenQueue.size() == 0) && (curCommandLen == 0) && (stateMeasureZ == IDLE);
+}
+
+//================================================================
+int main(int argc, char *argv[])
+{
+  bool pipeline = false;
+  uint64_t limitMs = 60000;
+  const char *scriptName = NULL;
+
+  for (int ii = 1; ii < argc; ii++) {
+    if (strcmp(argv[ii], "-p") == 0)                     { pipeline = true; }
+    else if (strcmp(argv[ii], "-q") == 0)                { optQuiet = true; }
+    else if (strcmp(argv[ii], "-r") == 0)                { optRaw = true; }
+    else if ((strcmp(argv[ii], "-s") == 0) && (ii + 1 < argc)) { admxSim.cfg.samplePeriodUs = atoi(argv[++ii]); }
+    else if ((strcmp(argv[ii], "-t") == 0) && (ii + 1 < argc)) { limitMs = atoll(argv[++ii]); }
+    else if ((strcmp(argv[ii], "-l") == 0) && (ii + 1 < argc)) {
+      unsigned op, us;
+      if (sscanf(argv[++ii], "%x=%u", &op, &us) == 2 && op < 256) { admxSim.cfg.latencyUs[op] = us; }
+    }
+    else if (argv[ii][0] != '-')                         { scriptName = argv[ii]; }
+    else {
+      fprintf(stderr, "unknown option %s\n", argv[ii]);
+      return 1;
+    }
+  }
+
+  //-------- read all command lines first
+  FILE *in = scriptName ? fopen(scriptName, "r") : stdin;
+  if (in == NULL) {
+    fprintf(stderr, "can't open %s\n", scriptName);
+    return 1;
+  }
+  std::vector<std::string> lines;
+  std::string line;
+  int ch;
+  while ((ch = fgetc(in)) != EOF) {   // no line length limit - long lines test the receiver
+    if (ch != '\n') {
+      line += (char)ch;
+      continue;
+    }
+    while (!line.empty() && (line.back() == '\r')) {
+      line.pop_back();
+    }
+    if (!line.empty() && (line[0] != '#')) {   // # starts a comment line in the scripts
+      lines.push_back(line + "\n");
+    }
+    line.clear();
+  }
+  if (!line.empty() && (line[0] != '#')) {     // last line without LF
+    lines.push_back(line + "\n");
+  }
+  if (in != stdin) {
+    fclose(in);
+  }
+
+  setup();
+
+  size_t nextLine = 0;
+  if (pipeline) {
+    for (; nextLine < lines.size(); nextLine++) {
+      HostSim_FeedInput(lines[nextLine].c_str(), lines[nextLine].size());
+    }
+  }
+
+  uint64_t startNs = HostSim_NowNs();
+  int idleLoops = 0;
+  while ((HostSim_NowNs() - startNs) / 1000000ULL < limitMs) {
+    if ((nextLine < lines.size()) && (lines[nextLine][0] == '@')) {   // timed line - doesn't wait for idle
+      char *cmndPos;
+      unsigned long atMs = strtoul(lines[nextLine].c_str() + 1, &cmndPos, 10);
+      if ((HostSim_NowNs() - startNs) / 1000000ULL >= atMs) {
+        while (*cmndPos == ' ') {
+          cmndPos++;
+        }
+        HostSim_FeedInput(cmndPos, strlen(cmndPos));
+        nextLine++;
+      }
+    }
+    else if ((nextLine < lines.size()) && BridgeIdle()) {
+      HostSim_FeedInput(lines[nextLine].c_str(), lines[nextLine].size());
+      nextLine++;
+    }
+
+    loop();
+    HostSim_AdvanceNs(LOOP_COST_NS);
+
+    idleLoops = BridgeIdle() ? idleLoops + 1 : 0;
+    if ((nextLine >= lines.size()) && (idleLoops > 10)) {
+      break;   // all commands done
+    }
+  }
+  fflush(stdout);
+
+  //-------- summary
+  uint64_t elapsedUs = (HostSim_NowNs() - startNs) / 1000ULL;
+  fprintf(stderr, "--- virtual time %llu us, %u frames, %u samples, %u FIFO overflows, %llu bytes out in %llu USB writes\n",
+          (unsigned long long)elapsedUs, admxSim.framesTotal, admxSim.samplesProduced, admxSim.fifoOverflows,
+          (unsigned long long)bytesOut, (unsigned long long)usbWrites);
+  for (int op = 0; op < 256; op++) {
+    if (admxSim.framesByOpcode[op]) {
+      fprintf(stderr, "    opcode 0x%02X : %u frames\n", op, admxSim.framesByOpcode[op]);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,37 @@
+//================================================================
+// ADMX2001B USB to SPI bridge - host simulator
+// SPI library shim - bytes are routed into the ADMX2001 model
+// IDEX Biometrics UK
+//
+// 17-10-26 -- Creating the file
+//
+//================================================================
+#ifndef _HOST_SPI_H
+#define _HOST_SPI_H
+
+#include "Arduino.h"
+
+#define MSBFIRST   1
+#define SPI_MODE0  0
+
+class SPISettings {
+public:
+  SPISettings(uint32_t clock = 4000000, int bitOrder = MSBFIRST, int dataMode = SPI_MODE0) : clockHz(clock) { (void)bitOrder; (void)dataMode; }
+  uint32_t clockHz;
+};
+
+class SPIClass {
+public:
+  void begin(void) {}
+  void end(void) {}
+  void beginTransaction(SPISettings settings) { clockHz = settings.clockHz; }
+  void endTransaction(void) {}
+  uint8_t transfer(uint8_t data);
+  void transfer(void *buf, size_t count);   // in place transfer of the whole buffer
+
+  uint32_t clockHz = 4000000;
+};
+
+extern SPIClass SPI;
+
+#endif // end _HOST_SPI_H
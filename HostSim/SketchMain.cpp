@@ -0,0 +1,2 @@
+// host build of the sketch - the Arduino IDE compiles the .ino itself, on the PC we include it
+#include "../Arduino_SPI_ADMX_Bridge/Arduino_SPI_ADMX_Bridge.ino"
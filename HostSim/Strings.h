@@ -0,0 +1,2 @@
+// host shim - nothing to declare, String lives in Arduino.h
+#include "Arduino.h"
@@ -0,0 +1,2 @@
+// host shim - the Renesas core header is not needed on the PC
+#include "../Arduino.h"
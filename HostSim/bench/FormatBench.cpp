@@ -0,0 +1,101 @@
+//================================================================
+// Host benchmark for FormatSci7() against sprintf("%.7e")
+// - checks the text is byte-identical on edge cases and random values
+// - times both on the same values
+//
+//   g++ -std=gnu++17 -O2 -o fmt_bench HostSim/bench/FormatBench.cpp Arduino_SPI_ADMX_Bridge/FastFormat.cpp
+//   ./fmt_bench [count]
+//
+// 17-10-26 -- Creating the file
+//================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "../../Arduino_SPI_ADMX_Bridge/FastFormat.h"
+
+static unsigned long mismatches = 0;
+
+//================================================================
+static void Check(double val)
+{
+  char fast[SCI7_BUF_LEN + 8];
+  char ref[64];
+  int lenFast = FormatSci7(val, fast);
+  int lenRef = snprintf(ref, sizeof(ref), "%.7e", val);
+  if ((lenFast != lenRef) || strcmp(fast, ref) != 0) {
+    if (mismatches < 20) {
+      printf("MISMATCH %.17g: fast <%s> ref <%s>\n", val, fast, ref);
+    }
+    mismatches++;
+  }
+}
+
+//================================================================
+int main(int argc, char *argv[])
+{
+  long count = (argc > 1) ? atol(argv[1]) : 2000000;
+  std::mt19937_64 rng(12345);
+
+  //--------- edge cases - zero, sign, carries, ties, ranges
+  const double edges[] = {
+    0.0, -0.0, 1.0, -1.0, 9.99999995, 9.999999949999, 9.99999999, 99999999.5, 0.5, 1.5,
+    1.00000005, 1.00000015, 1.23456785, 2.5e-7, 1e22, 1e23, 1e-15, 1e-16, 1e29, 1e30,
+    1e100, -1e-100, 1e300, 4.9e-324, 1.7976931348623157e308, 123456789012.0,
+    INFINITY, -INFINITY, NAN, 3.0f / 7.0f, 0.1f, 1e-3, 50.0, 1234.5678
+  };
+  for (double val : edges) {
+    Check(val);
+  }
+
+  //--------- exact ties in the 9th digit and their neighbours
+  for (long ii = 0; ii < 200000; ii++) {
+    double base = (double)(10000000 + (rng() % 90000000)) + 0.5;
+    int exp10 = (int)(rng() % 31) - 15;
+    double val = base * pow(10.0, exp10 - 7);
+    Check(val);
+    Check(nextafter(val, 0));
+    Check(nextafter(val, INFINITY));
+  }
+
+  //--------- random bit patterns - every exponent
+  for (long ii = 0; ii < count / 4; ii++) {
+    uint64_t bits = rng();
+    double val;
+    memcpy(&val, &bits, sizeof(val));
+    Check(val);
+  }
+
+  //--------- typical measurement values, log uniform 1e-6 .. 1e12
+  std::uniform_real_distribution<double> logDist(-6.0, 12.0);
+  std::vector<double> values(count);
+  for (long ii = 0; ii < count; ii++) {
+    values[ii] = ((rng() & 1) ? -1.0 : 1.0) * pow(10.0, logDist(rng));
+    Check(values[ii]);
+  }
+  printf("checked, %lu mismatches, %lu fallbacks to snprintf\n", mismatches, sci7Fallbacks);
+
+  //--------- timing on the measurement values
+  char buffer[64];
+  unsigned long sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (long ii = 0; ii < count; ii++) {
+    sink += sprintf(buffer, "%.7e", values[ii]);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (long ii = 0; ii < count; ii++) {
+    sink += FormatSci7(values[ii], buffer);
+  }
+  auto t2 = std::chrono::steady_clock::now();
+
+  double nsRef = std::chrono::duration<double, std::nano>(t1 - t0).count() / count;
+  double nsFast = std::chrono::duration<double, std::nano>(t2 - t1).count() / count;
+  printf("sprintf    %7.1f ns/value\n", nsRef);
+  printf("FormatSci7 %7.1f ns/value  (x%.1f, %lu chars)\n", nsFast, nsRef / nsFast, sink);
+
+  return (mismatches == 0) ? 0 : 1;
+}
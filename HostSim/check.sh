@@ -0,0 +1,39 @@
+#!/bin/sh
+#================================================================
+# ADMX2001B USB to SPI bridge - host simulator regression check
+# Builds admx_sim, runs every HostSim/scripts/*.txt and compares the bridge output
+# (stdout, delimiter shown as <DL>) with HostSim/scripts/<name>.expected
+#
+# Run from the repository root:
+#   sh HostSim/check.sh            compare, exit code 1 on any difference
+#   sh HostSim/check.sh update     write the current output as the new expected files
+#
+# A script can pass options to admx_sim in a line "# sim: <options>" (e.g. "# sim: -s 200").
+# The stderr summary (virtual time, frames) is not compared - it changes with every speedup.
+#
+# 17-10-26 -- Creating the file
+#
+#================================================================
+SIM=${SIM:-./admx_sim}
+OUT=${TMPDIR:-/tmp}/admx_check.$$
+
+g++ -std=gnu++17 -O2 -I HostSim -o "$SIM" HostSim/*.cpp Arduino_SPI_ADMX_Bridge/*.cpp || exit 1
+
+failed=0
+for script in HostSim/scripts/*.txt; do
+  expected="${script%.txt}.expected"
+  opts=$(sed -n 's/^# sim: //p' "$script")
+  timeout 120 "$SIM" $opts "$script" > "$OUT" 2>/dev/null
+  if [ "$1" = "update" ]; then
+    cp "$OUT" "$expected"
+    echo "updated $expected"
+  elif cmp -s "$OUT" "$expected"; then
+    echo "ok      $script"
+  else
+    echo "FAILED  $script"
+    diff "$expected" "$OUT" | head -20
+    failed=1
+  fi
+done
+rm -f "$OUT"
+exit $failed